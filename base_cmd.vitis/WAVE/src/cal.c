@@ -26,15 +26,38 @@ THE SOFTWARE.
 
 #include "main.h"
 #include "cal.h"
+#include "fs.h"
+#include "frame.h"
+#include "log.h"
+#include <string.h>
+#include <stddef.h>
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
 
 #define FACTORY_FLASH_BASE_ADDR 0xC0800000
 
+// Link training cache. The factory header's flash is only mapped for reading, so the cache lives on the SSD.
+#define CAL_LINK_PATH "/lvds.bin"
+#define CAL_LINK_VERSION 1
+#define CAL_LINK_BINS 6
+#define CAL_LINK_BIN_WIDTH 15.0f			// [C], so bins start at <15C, 15-30C, ... and end at >75C.
+
 // Private Type Definitions --------------------------------------------------------------------------------------------
 
+typedef struct __attribute__((packed))
+{
+	char strMagic[4];
+	u16 version;
+	u16 nBins;
+	CalLinkTrain_s bin[CAL_LINK_BINS];
+	u32 crc32c;							// Over everything above.
+} CalLinkCache_s;
+
 // Private Function Prototypes -----------------------------------------------------------------------------------------
 
+void calLoadLinkCache(void);
+u32 calGetLinkBin(float tempC);
+
 // Public Global Variables ---------------------------------------------------------------------------------------------
 
 FactoryHeader_s fhActive;
@@ -42,6 +65,9 @@ FactoryHeader_s fhActive;
 // Private Global Variables --------------------------------------------------------------------------------------------
 
 FactoryHeader_s * const fhFlash = (FactoryHeader_s * const)(FACTORY_FLASH_BASE_ADDR);
+CalLinkCache_s calLinkCache;
+u8 calLinkCacheLoaded = 0;
+
 FactoryHeader_s fhDefault = { .strDelimiter = "WAVE HELLO\n",
 							  .version = {0, 0, 0},				// v0.0.0 indicates default cal
 							  .cmvTempDN0 = 1860.0f,			// CMV12000 Datasheet Figure 3
@@ -67,4 +93,56 @@ void calInit(void)
 	}
 }
 
+const CalLinkTrain_s * calGetLinkTrain(float tempC)
+{
+	const CalLinkTrain_s * linkTrain;
+
+	calLoadLinkCache();
+
+	linkTrain = &calLinkCache.bin[calGetLinkBin(tempC)];
+	return linkTrain->valid ? linkTrain : NULL;
+}
+
+void calSaveLinkTrain(const CalLinkTrain_s * linkTrain)
+{
+	calLoadLinkCache();
+
+	memcpy(&calLinkCache.bin[calGetLinkBin(linkTrain->tempC)], linkTrain, sizeof(CalLinkTrain_s));
+	calLinkCache.crc32c = frameCRC32C((u64) &calLinkCache, offsetof(CalLinkCache_s, crc32c));
+
+	if(!fsSaveFile(CAL_LINK_PATH, &calLinkCache, sizeof(CalLinkCache_s)))
+	{
+		LOG_WARNING("Warning: Link training cache write failed.\r\n");
+	}
+}
+
 // Private Function Definitions ----------------------------------------------------------------------------------------
+
+// Read the cache from the SSD once. Anything missing, stale, or corrupt starts an empty cache.
+void calLoadLinkCache(void)
+{
+	u32 nBytes;
+
+	if(calLinkCacheLoaded) { return; }
+	calLinkCacheLoaded = 1;
+
+	nBytes = fsLoadFile(CAL_LINK_PATH, &calLinkCache, sizeof(CalLinkCache_s));
+	if((nBytes == sizeof(CalLinkCache_s))
+	&& (memcmp(calLinkCache.strMagic, "LVDS", 4) == 0)
+	&& (calLinkCache.version == CAL_LINK_VERSION)
+	&& (calLinkCache.nBins == CAL_LINK_BINS)
+	&& (calLinkCache.crc32c == frameCRC32C((u64) &calLinkCache, offsetof(CalLinkCache_s, crc32c))))
+	{ return; }
+
+	memset(&calLinkCache, 0, sizeof(CalLinkCache_s));
+	memcpy(calLinkCache.strMagic, "LVDS", 4);
+	calLinkCache.version = CAL_LINK_VERSION;
+	calLinkCache.nBins = CAL_LINK_BINS;
+}
+
+u32 calGetLinkBin(float tempC)
+{
+	if(tempC < CAL_LINK_BIN_WIDTH) { return 0; }
+	if(tempC >= (CAL_LINK_BIN_WIDTH * (CAL_LINK_BINS - 1))) { return CAL_LINK_BINS - 1; }
+	return (u32)(tempC / CAL_LINK_BIN_WIDTH);
+}
@@ -31,6 +31,8 @@ THE SOFTWARE.
 
 // Public Pre-Processor Definitions ------------------------------------------------------------------------------------
 
+#define CAL_LINK_CHANNELS 65		// [63:0] are pixel channels, [64] is the control channel.
+
 // Public Type Definitions ---------------------------------------------------------------------------------------------
 
 typedef struct __attribute__((packed))
@@ -43,10 +45,27 @@ typedef struct __attribute__((packed))
 	u16 cmvVtfl2K;
 } FactoryHeader_s;
 
+// CMV12000 LVDS link training result, cached on the SSD for the temperature it was trained at.
+typedef struct __attribute__((packed))
+{
+	float tempC;						// PL temperature during training. IDELAY taps drift with it.
+	u32 tTrain_ms;						// Duration of the full sweep, to report time saved by the cache.
+	u8 valid;
+	u8 phase;
+	u8 delay[CAL_LINK_CHANNELS];		// IDELAY tap at the eye center.
+	u8 bitslip[CAL_LINK_CHANNELS];
+} CalLinkTrain_s;
+
 // Public Function Prototypes ------------------------------------------------------------------------------------------
 
 void calInit(void);
 
+// Cached link training result for the temperature's bin, or NULL if there isn't one.
+const CalLinkTrain_s * calGetLinkTrain(float tempC);
+
+// Replace the cached result for the temperature's bin and write the cache back to the SSD.
+void calSaveLinkTrain(const CalLinkTrain_s * linkTrain);
+
 // Externed Public Global Variables ------------------------------------------------------------------------------------
 
 extern FactoryHeader_s fhActive;
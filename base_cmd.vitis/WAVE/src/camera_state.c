@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "wavelet.h"
 #include "encoder.h"
 #include "frame.h"
+#include "fs.h"
 #include "hdmi.h"
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
@@ -37,6 +38,10 @@ THE SOFTWARE.
 #define CSETTING_HEIGHT_ENABLE_4K 0x000000000FFFFFFF
 #define CSETTING_HEIGHT_ENABLE_2K 0x000000000FFFFF80
 
+// Recording rate model.
+#define CSTATE_SSD_RATE_MARGIN 0.9f		// Fraction of the SSD write rate to plan for.
+#define CSTATE_DDR_USABLE 0.5f			// Fraction of codestream RAM filled before high-pass codestreams are dropped.
+
 // Private Type Definitions --------------------------------------------------------------------------------------------
 
 // Private Function Prototypes -----------------------------------------------------------------------------------------
@@ -239,7 +244,8 @@ CameraSettingValue_s cSettingGainValArray[] = {{" LINEAR ", 0.0f},
 char * cSettingFormatName = " FORMAT ";
 char * cSettingFormatValFormat = " %6d ";
 CameraSettingValue_s cSettingFormatValArray[] = {{"Cancel  ", 0.0f},
-												 {"Confirm ", 1.0f}};
+												 {"Confirm ", 1.0f},
+												 {"Bench   ", 2.0f}};
 
 // Interrupt Handlers --------------------------------------------------------------------------------------------------
 
@@ -375,8 +381,8 @@ void cStateInit(void)
 
 	cSettingFormat.id = 7;
 	cSettingFormat.val = 0;
-	cSettingFormat.count = 2;
-	cSettingFormat.enable[0] = 0x0000000000000003;
+	cSettingFormat.count = 3;
+	cSettingFormat.enable[0] = 0x0000000000000007;
 	cSettingFormat.enable[1] = 0x0000000000000000;
 	cSettingFormat.enable[2] = 0x0000000000000000;
 	cSettingFormat.enable[3] = 0x0000000000000000;
@@ -435,6 +441,48 @@ u8 cSettingGetUser(u8 id, u8 val)
 	return ((cState.cSetting[id]->user[word]) >> bit) & 0x1;
 }
 
+// Expected recording time in [s] before the backlog forces dropping data, at the current resolution, frame
+// rate, and compression ratio. Uses the benchmarked SSD write rate and, once seen, the sustained rate and fast
+// cache size learned by the frame recorder. CSTATE_RECORD_TIME_UNKNOWN if the SSD hasn't been benchmarked.
+u32 cStateGetRecordTime(void)
+{
+	float fps, rateData;
+	float rateFast, rateSlow;
+	float bytesDDR, bytesCache;
+	float tRecord;
+
+	if(fsWriteRate <= 0.0f) { return CSTATE_RECORD_TIME_UNKNOWN; }
+
+	fps = cSettingFPS.valArray[cSettingFPS.val].fVal;
+	if(fps > cStateGetMaxFPS()) { fps = cStateGetMaxFPS(); }
+	rateData = cSettingWidth.valArray[cSettingWidth.val].fVal * cSettingHeight.valArray[cSettingHeight.val].fVal
+	         * 1.25f * fps / frameCompressionRatio;	// 1.25B/px
+
+	rateFast = CSTATE_SSD_RATE_MARGIN * fsWriteRate;
+	if(frameSSDRateSustained > 0.0f) { rateSlow = CSTATE_SSD_RATE_MARGIN * frameSSDRateSustained; }
+	else { rateSlow = rateFast; }
+
+	if(rateData <= rateSlow) { return CSTATE_RECORD_TIME_SUSTAINABLE; }
+
+	bytesDDR = CSTATE_DDR_USABLE * (float)encoderGetRAMSize();
+
+	if(rateData > rateFast)
+	{
+		// Backlog builds from the start.
+		tRecord = bytesDDR / (rateData - rateFast);
+	}
+	else
+	{
+		// Keeps up until the fast cache fills, then the backlog builds at the sustained rate.
+		bytesCache = 0.0f;
+		if(frameSSDCacheBytes > frameSSDBytesSinceIdle) { bytesCache = (float)(frameSSDCacheBytes - frameSSDBytesSinceIdle); }
+		tRecord = bytesCache / rateData + bytesDDR / (rateData - rateSlow);
+	}
+
+	if(tRecord > 99999.0f) { tRecord = 99999.0f; }
+	return (u32) tRecord;
+}
+
 // Private Function Definitions ----------------------------------------------------------------------------------------
 
 void cSettingModeSetVal(u8 val)
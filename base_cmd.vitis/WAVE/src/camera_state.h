@@ -67,6 +67,10 @@ THE SOFTWARE.
 #define CSETTING_FORMAT 7
 #define CSETTING_FORMAT_CANCEL 0
 #define CSETTING_FORMAT_CONFIRM 1
+#define CSETTING_FORMAT_BENCHMARK 2
+
+#define CSTATE_RECORD_TIME_SUSTAINABLE 0xFFFFFFFF
+#define CSTATE_RECORD_TIME_UNKNOWN 0xFFFFFFFE
 
 #define CSETTING_UI_DISPLAY_TYPE_NAME 0
 #define CSETTING_UI_DISPLAY_TYPE_VAL_ARRAY 1
@@ -108,6 +112,7 @@ void cStateInit(void);
 void cStateApply(void);
 u8 cSettingGetEnabled(u8 id, u8 val);
 u8 cSettingGetUser(u8 id, u8 val);
+u32 cStateGetRecordTime(void);
 
 // Externed Public Global Variables ------------------------------------------------------------------------------------
 extern CameraState_s cState;
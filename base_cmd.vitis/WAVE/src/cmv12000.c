@@ -26,9 +26,11 @@ THE SOFTWARE.
 
 #include "cmv12000.h"
 #include "supervisor.h"
+#include "log.h"
 #include "gpio.h"
 #include "camera_state.h"
 #include "cal.h"
+#include <string.h>
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
 
@@ -54,11 +56,22 @@ THE SOFTWARE.
 #define CMV_TP1 0x0055
 #define CMV_TPC 0x0080
 
+// Reads of every channel in the short link check, about 1us apart.
+#define CMV_LINK_CHECK_READS 64
+
+// IDELAY taps probed either side of each eye center before a link training result is trusted. A tap that has
+// drifted toward the edge of its eye still passes at the center, but fails on one side.
+#define CMV_LINK_MARGIN_TAPS 4
+
 // Private Type Definitions --------------------------------------------------------------------------------------------
 
 // Private Function Prototypes -----------------------------------------------------------------------------------------
 
 void cmvLinkTrain(void);
+void cmvLinkTrainFull(CalLinkTrain_s * linkTrain);
+void cmvLinkApply(const CalLinkTrain_s * linkTrain);
+u8 cmvLinkCheck(void);
+u8 cmvLinkCheckMargin(const CalLinkTrain_s * linkTrain);
 
 void cmvRegInit(XSpiPs * spiDevice);
 void cmvRegSetMode(XSpiPs * spiDevice);
@@ -68,7 +81,7 @@ void cmvRegWrite(XSpiPs * spiDevice, u8 addr, u16 val);
 
 // Public Global Variables ---------------------------------------------------------------------------------------------
 
-CMV_Input_s * CMV_Input = (CMV_Input_s *) 0xA0000000;
+OCM_DATA CMV_Input_s * CMV_Input = (CMV_Input_s *) 0xA0000000;
 CMV_Settings_s CMV_Settings_W;
 
 // Private Global Variables --------------------------------------------------------------------------------------------
@@ -76,6 +89,8 @@ CMV_Settings_s CMV_Settings_W;
 XSpiPs Spi0;
 XSpiPs_Config *spi0Config;
 
+float cmvTf = -100.0f;		// Filtered sensor temperature in [C], -100 until the first update.
+
 // Registers that are initialized to constant but non-default values.
 u8 cmvRegAddrInit[] =
 {
@@ -138,7 +153,10 @@ void cmvInit(void)
 	XGpioPs_WritePin(&Gpio, PX_IN_RST_PIN, 1);
 
 	// Tell the supervisor to enable the CMV12000 power supplies. Wait for power good signals.
-	supervisorEnableCMVPower();
+	if(supervisorEnableCMVPower() != SUPERVISOR_OK)
+	{
+		LOG_WARNING("Warning: CMV12000 power good timed out.\r\n");
+	}
 	usleep(1000);
 
 	// Start the 600MHz LVDS clock.
@@ -328,14 +346,13 @@ void cmvSetVtfl(u8 Vtfl2, u8 Vtfl3)
 	CMV_Settings_W.Vtfl = ((u16)(Vtfl3 & 0x7F) << 7) | (u16)(Vtfl2 & 0x7F);
 }
 
-float cmvGetTemp(void)
+// Step the sensor temperature filter. Core 0 only, once per UI pass.
+void cmvUpdateTemp(void)
 {
 	float cmvDN0 = fhActive.cmvTempDN0;
 	float cmvT0 = fhActive.cmvTempT0;
 	float cmvTSlope = 0.143f;
 
-	static float cmvTf = -100.0f;
-
 	float cmvT = ((float)(CMV_Settings_R.Temp_sensor) - cmvDN0) * cmvTSlope + cmvT0;
 	if(cmvTf == -100.0f)
 	{
@@ -345,7 +362,11 @@ float cmvGetTemp(void)
 	{
 		cmvTf = 0.95f * cmvTf + 0.05f * cmvT;
 	}
+}
 
+// Last filtered sensor temperature in [C]. Safe from either core.
+float cmvGetTemp(void)
+{
 	return cmvTf;
 }
 
@@ -359,6 +380,66 @@ u32 cmvGetExposure(void)
 
 // CMV12000 Link Training Routine
 void cmvLinkTrain(void)
+{
+	CalLinkTrain_s linkTrain;
+	const CalLinkTrain_s * linkCached;
+	XTime tStart, tEnd;
+	u32 tTrain_ms;
+	u8 trained = 0;
+
+	memset(&linkTrain, 0, sizeof(CalLinkTrain_s));
+	linkTrain.tempC = psplGetTemp(plTemp);
+	XTime_GetTime(&tStart);
+
+	// Try the result cached for this temperature first. The sensor idles on its training patterns, so short checks
+	// at and around the cached taps show whether they still sit well inside the eyes.
+	linkCached = calGetLinkTrain(linkTrain.tempC);
+	if(linkCached != NULL)
+	{
+		trained = cmvLinkCheckMargin(linkCached);
+
+		XTime_GetTime(&tEnd);
+		tTrain_ms = (tEnd - tStart) / (COUNTS_PER_SECOND / 1000);
+		if(trained)
+		{
+			LOG_INFO("CMV12000 link restored from cache in %d ms, saving %d ms.\r\n",
+			         tTrain_ms, (s32) linkCached->tTrain_ms - (s32) tTrain_ms);
+		}
+		else
+		{
+			LOG_INFO("CMV12000 link cache margin check failed, running full training.\r\n");
+		}
+	}
+
+	if(!trained)
+	{
+		XTime_GetTime(&tStart);
+		cmvLinkTrainFull(&linkTrain);
+		XTime_GetTime(&tEnd);
+		linkTrain.tTrain_ms = (tEnd - tStart) / (COUNTS_PER_SECOND / 1000);
+
+		// Only cache a result that passes the same check it will be held to at the next boot.
+		if(cmvLinkCheckMargin(&linkTrain))
+		{
+			linkTrain.valid = 1;
+			calSaveLinkTrain(&linkTrain);
+			LOG_INFO("CMV12000 link trained in %d ms.\r\n", linkTrain.tTrain_ms);
+		}
+		else
+		{
+			LOG_WARNING("Warning: CMV12000 link training check failed.\r\n");
+		}
+	}
+
+    // Disable px_count_limit by setting it to max.
+    CMV_Input->px_count_limit = 0x7FFFFF;
+
+    // Make sure the FOT interrupt flag is cleared.
+    CMV_Input->FOT_int = 0;
+}
+
+// Full link training: phase, IDELAY sweep, and bit slip search.
+void cmvLinkTrainFull(CalLinkTrain_s * linkTrain)
 {
     // Stage 1: Find the correct phase for the deserializer clocks.
     // -----------------------------------------------------------------------------------------
@@ -513,11 +594,69 @@ void cmvLinkTrain(void)
     }
     // -----------------------------------------------------------------------------------------
 
-    // Disable px_count_limit by setting it to max.
-    CMV_Input->px_count_limit = 0x7FFFFF;
+    linkTrain->phase = px_phase;
+    for(u32 ch = 0; ch < 65; ch++)
+    {
+    	linkTrain->delay[ch] = px_eye_center[ch];
+    	linkTrain->bitslip[ch] = (ch < 64) ? chXX_bitslip[ch] : ctr_bitslip;
+    }
+}
 
-    // Make sure the FOT interrupt flag is cleared.
-    CMV_Input->FOT_int = 0;
+void cmvLinkApply(const CalLinkTrain_s * linkTrain)
+{
+	for(u32 ch = 0; ch < CAL_LINK_CHANNELS; ch++)
+	{
+		CMV_Input->ch[ch] &= ~(PX_PHASE_MASK | PX_DELAY_MASK | PX_BITSLIP_MASK);
+		CMV_Input->ch[ch] |= ((u32) linkTrain->phase << PX_PHASE_POS)
+		                   | ((u32) linkTrain->delay[ch] << PX_DELAY_POS)
+		                   | ((u32) linkTrain->bitslip[ch] << PX_BITSLIP_POS);
+	}
+
+	// Same settling time as a step of the full delay sweep.
+	usleep(1000);
+}
+
+// Short stability check: every channel must read its training pattern, every time.
+u8 cmvLinkCheck(void)
+{
+	for(u32 i = 0; i < CMV_LINK_CHECK_READS; i++)
+	{
+		if((CMV_Input->ch[64] & PX_DATA_MASK) != CMV_TPC) { return 0; }
+		for(u32 ch = 0; ch < 64; ch++)
+		{
+			if((CMV_Input->ch[ch] & PX_DATA_MASK) != CMV_TP1) { return 0; }
+		}
+		usleep(1);
+	}
+
+	return 1;
+}
+
+// Apply a link training result and check it at, and CMV_LINK_MARGIN_TAPS either side of, each channel's delay tap.
+// Leaves the link at the result's own taps.
+u8 cmvLinkCheckMargin(const CalLinkTrain_s * linkTrain)
+{
+	CalLinkTrain_s linkProbe;
+	s32 delay;
+
+	memcpy(&linkProbe, linkTrain, sizeof(CalLinkTrain_s));
+
+	for(s32 offset = -CMV_LINK_MARGIN_TAPS; offset <= CMV_LINK_MARGIN_TAPS; offset += 2 * CMV_LINK_MARGIN_TAPS)
+	{
+		for(u32 ch = 0; ch < CAL_LINK_CHANNELS; ch++)
+		{
+			// No room for the probe in the delay line counts as no margin.
+			delay = (s32) linkTrain->delay[ch] + offset;
+			if((delay < 0) || (delay > 255)) { cmvLinkApply(linkTrain); return 0; }
+			linkProbe.delay[ch] = (u8) delay;
+		}
+
+		cmvLinkApply(&linkProbe);
+		if(!cmvLinkCheck()) { cmvLinkApply(linkTrain); return 0; }
+	}
+
+	cmvLinkApply(linkTrain);
+	return cmvLinkCheck();
 }
 
 void cmvRegInit(XSpiPs * spiDevice)
@@ -115,6 +115,7 @@ u32 cmvGetOffsets(void);
 void cmvSetOffsets(u16 offsetBot, u16 offsetTop);
 u16 cmvGetVtfl(void);
 void cmvSetVtfl(u8 Vtfl2, u8 Vtfl3);
+void cmvUpdateTemp(void);
 float cmvGetTemp(void);
 u32 cmvGetExposure(void);
 
@@ -10,6 +10,8 @@
 #include "ff.h"			/* Obtains integer types */
 #include "diskio.h"		/* Declarations of disk functions */
 #include "nvme.h"
+#include "memory_map.h"
+#include "xil_cache.h"
 
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
@@ -64,7 +66,12 @@ DRESULT disk_read (
 		nvmeServiceIOCompletions(16);
 	}
 
-	int nvmeRWStatus = nvmeRead(buff, (u64) sector, count);
+	int nvmeRWStatus;
+
+	// Cached buffers (e.g. the FatFs sector window) must have no dirty lines that could be evicted over the DMA data.
+	if(memMapIsCacheable((u64)buff)) { Xil_DCacheFlushRange((INTPTR)buff, count * 512); }
+
+	nvmeRWStatus = nvmeRead(buff, (u64) sector, count);
 	if(nvmeRWStatus != NVME_RW_OK) { return RES_ERROR; }
 
 	// No command slip allowed for reading. TO-DO: What about fast reading?
@@ -73,6 +80,9 @@ DRESULT disk_read (
 		nvmeServiceIOCompletions(16);
 	}
 
+	// Drop any lines speculatively filled while the DMA was in progress.
+	if(memMapIsCacheable((u64)buff)) { Xil_DCacheInvalidateRange((INTPTR)buff, count * 512); }
+
 	return RES_OK;
 }
 
@@ -90,13 +100,21 @@ DRESULT disk_write (
 )
 {
 	u8 nSlipAllowed = 0;
+	int nvmeRWStatus;
+
+	// Cached buffers (e.g. the FatFs sector window) must be written back before the SSD reads them.
+	if(memMapIsCacheable((u64)buff)) { Xil_DCacheFlushRange((INTPTR)buff, count * 512); }
 
-	int nvmeRWStatus = nvmeWrite(buff, (u64) sector, count);
+	nvmeRWStatus = nvmeWrite(buff, (u64) sector, count);
 	if(nvmeRWStatus != NVME_RW_OK) { return RES_ERROR; }
 
-	// APPLICATION SPECIFIC: If we're writing from image DDR4, allow write slip
-	// of up to 1/4 of the IO queue depth for high-speed transfer.
-	if((u64)buff > 0x10000000)
+	// APPLICATION SPECIFIC: If we're writing from one of the recording buffers in image DDR4, allow write slip
+	// of up to 1/4 of the IO queue depth for high-speed transfer. Those aren't reused until long after the write
+	// completes. Anything else, such as a FatFs work buffer on the stack, may be overwritten as soon as this returns.
+	if(memMapContains(MEM_MAP_ID_CS, (u64)buff, count * 512)
+	|| memMapContains(MEM_MAP_ID_FH, (u64)buff, count * 512)
+	|| memMapContains(MEM_MAP_ID_CLIP_INFO, (u64)buff, count * 512)
+	|| memMapContains(MEM_MAP_ID_TELEMETRY, (u64)buff, count * 512))
 	{
 		nSlipAllowed = 16;
 	}
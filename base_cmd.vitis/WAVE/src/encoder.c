@@ -26,6 +26,8 @@ THE SOFTWARE.
 
 #include "encoder.h"
 #include "camera_state.h"
+#include "memory_map.h"
+#include "log.h"
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
 
@@ -49,6 +51,12 @@ THE SOFTWARE.
 #define ENC_CTRL_C_RAM_ADDR_UPDATE_REQUEST  0x01000000
 #define ENC_CTRL_C_RAM_ADDR_UPDATE_COMPLETE 0x02000000
 
+// Codestream buffer partitions of the codestream region, in units of 1/78th: LL2 gets 24, the stage 2 high-pass
+// codestreams 6 each, and the stage 1 high-pass codestreams 3 each. A buffer is full once less than a frame's worth
+// of overrun space is left.
+#define ENC_CS_PARTITION_UNITS				78
+#define ENC_CS_OVERRUN						0x100000
+
 // Private Type Definitions --------------------------------------------------------------------------------------------
 
 // Private Function Prototypes -----------------------------------------------------------------------------------------
@@ -57,25 +65,21 @@ void encoderResetRAMAddr(Encoder_s * Encoder_local, u16 csFlags);
 
 // Public Global Variables ---------------------------------------------------------------------------------------------
 
-Encoder_s * Encoder = (Encoder_s *)(0xA0004000);
+OCM_DATA Encoder_s * Encoder = (Encoder_s *)(0xA0004000);
 
 // Private Global Variables --------------------------------------------------------------------------------------------
 
-u32 csBaseAddr[16] = {0x20000000, 0x38000000, 0x3E000000, 0x44000000,
-                      0x4A000000, 0x4D000000, 0x50000000, 0x53000000,
-                      0x56000000, 0x59000000, 0x5C000000, 0x5F000000,
-                      0x62000000, 0x65000000, 0x68000000, 0x6B000000};
+const u8 csPartitionUnits[16] = {24, 6, 6, 6, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3};
 
-u32 csFullAddr[16] = {0x37F00000, 0x3DF00000, 0x43F00000, 0x49F00000,
-                      0x4CF00000, 0x4FF00000, 0x52F00000, 0x55F00000,
-                      0x58F00000, 0x5BF00000, 0x5EF00000, 0x61F00000,
-                      0x64F00000, 0x67F00000, 0x6AF00000, 0x6DF00000};
+// Codestream buffer bounds, laid out by encoderInit().
+OCM_DATA u32 csBaseAddr[16];
+OCM_DATA u32 csFullAddr[16];
 
 // Quantizer Profiles from Most Compression <---> Least Compression
-u16 qMult_LH2_HL2[ENCODER_NUM_QMULT_PROFILES] = {16, 20, 29, 32, 37, 43, 52, 64, 86, 86, 128};
-u16 qMult_HH2[ENCODER_NUM_QMULT_PROFILES] = {8, 10, 14, 18, 22, 26, 29, 32, 37, 43, 52};
-u16 qMult_LH1_HL1[ENCODER_NUM_QMULT_PROFILES] = {8, 10, 12, 14, 16, 18, 22, 26, 29, 32, 43};
-u16 qMult_HH1[ENCODER_NUM_QMULT_PROFILES] = {4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 16};
+OCM_DATA u16 qMult_LH2_HL2[ENCODER_NUM_QMULT_PROFILES] = {16, 20, 29, 32, 37, 43, 52, 64, 86, 86, 128};
+OCM_DATA u16 qMult_HH2[ENCODER_NUM_QMULT_PROFILES] = {8, 10, 14, 18, 22, 26, 29, 32, 37, 43, 52};
+OCM_DATA u16 qMult_LH1_HL1[ENCODER_NUM_QMULT_PROFILES] = {8, 10, 12, 14, 16, 18, 22, 26, 29, 32, 43};
+OCM_DATA u16 qMult_HH1[ENCODER_NUM_QMULT_PROFILES] = {4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 16};
 
 // Interrupt Handlers --------------------------------------------------------------------------------------------------
 
@@ -83,6 +87,17 @@ u16 qMult_HH1[ENCODER_NUM_QMULT_PROFILES] = {4, 6, 7, 8, 9, 10, 11, 12, 13, 14,
 
 void encoderInit(void)
 {
+	u64 csAddr = memMapGetBase(MEM_MAP_ID_CS);
+	u64 csUnit = memMapGetSize(MEM_MAP_ID_CS) / ENC_CS_PARTITION_UNITS;
+
+	// Lay out the codestream buffers back to back in the codestream region.
+	for(int iCS = 0; iCS < 16; iCS++)
+	{
+		csBaseAddr[iCS] = (u32) csAddr;
+		csAddr += csPartitionUnits[iCS] * csUnit;
+		csFullAddr[iCS] = (u32)(csAddr - ENC_CS_OVERRUN);
+	}
+
 	// Configure the Encoder and arm the AXI Master.
 	Encoder->q_mult_HH1_HL1_LH1 = 0x00100020;
 	Encoder->q_mult_HH2_HL2_LH2 = 0x00200040;
@@ -90,6 +105,13 @@ void encoderInit(void)
 
 	encoderApplyCameraState();
 
+	// Each codestream buffer, plus one frame of overrun past its full address, must be in the codestream region.
+	for(int iCS = 0; iCS < 16; iCS++)
+	{
+		if(!memMapContains(MEM_MAP_ID_CS, csBaseAddr[iCS], csFullAddr[iCS] - csBaseAddr[iCS] + ENC_CS_OVERRUN))
+		{ LOG_ERROR("Error: Codestream %d buffer is outside of the codestream region.\r\n", iCS); }
+	}
+
 	encoderResetRAMAddr(Encoder, 0xFFFF);
 }
 
@@ -111,7 +133,7 @@ void encoderApplyCameraState(void)
 	}
 }
 
-void encoderServiceFOT(Encoder_s * Encoder_snapshot, u8 qMultProfile)
+OCM_TEXT void encoderServiceFOT(Encoder_s * Encoder_snapshot, u8 qMultProfile)
 {
 	u16 csFlags = 0x0000;
 
@@ -135,9 +157,48 @@ void encoderServiceFOT(Encoder_s * Encoder_snapshot, u8 qMultProfile)
 	}
 }
 
+// Fraction of the fullest codestream RAM buffer between read (SSD) and write (encoder) addresses.
+float encoderGetRAMFill(const u32 * csAddrRd, const u32 * csAddrWr)
+{
+	u32 used;
+	float fill;
+	float fillMax = 0.0f;
+
+	for(int iCS = 0; iCS < 16; iCS++)
+	{
+		if(csAddrWr[iCS] >= csAddrRd[iCS])
+		{ used = csAddrWr[iCS] - csAddrRd[iCS]; }
+		else
+		{ used = (csAddrWr[iCS] - csBaseAddr[iCS]) + (csFullAddr[iCS] - csAddrRd[iCS]); }	// Wrapped.
+
+		fill = (float)used / (float)(csFullAddr[iCS] - csBaseAddr[iCS]);
+		if(fill > fillMax) { fillMax = fill; }
+	}
+
+	return fillMax;
+}
+
+// Total codestream RAM buffer size in [B].
+u32 encoderGetCSBase(u8 iCS)
+{
+	return csBaseAddr[iCS];
+}
+
+u32 encoderGetRAMSize(void)
+{
+	u32 size = 0;
+
+	for(int iCS = 0; iCS < 16; iCS++)
+	{
+		size += csFullAddr[iCS] - csBaseAddr[iCS];
+	}
+
+	return size;
+}
+
 // Private Function Definitions ----------------------------------------------------------------------------------------
 
-void encoderResetRAMAddr(Encoder_s * Encoder_snapshot, u16 csFlags)
+OCM_TEXT void encoderResetRAMAddr(Encoder_s * Encoder_snapshot, u16 csFlags)
 {
 	for(int iCS = 0; iCS < 16; iCS++)
 	{
@@ -55,6 +55,11 @@ typedef struct __attribute__((packed))
 void encoderInit(void);
 void encoderApplyCameraState(void);
 void encoderServiceFOT(Encoder_s * Encoder_snapshot, u8 qMultProfile);
+float encoderGetRAMFill(const u32 * csAddrRd, const u32 * csAddrWr);
+u32 encoderGetRAMSize(void);
+
+// Start address of codestream iCS's buffer, as laid out by encoderInit().
+u32 encoderGetCSBase(u8 iCS);
 
 // Externed Public Global Variables ------------------------------------------------------------------------------------
 
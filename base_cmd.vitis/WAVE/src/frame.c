@@ -29,139 +29,302 @@ THE SOFTWARE.
 #include "gpio.h"
 #include "cmv12000.h"
 #include "encoder.h"
+#include "wavelet.h"
 #include "fs.h"
 #include "nvme.h"
 #include "camera_state.h"
 #include "hdmi_dark_frame.h"
+#include "verify.h"
+#include "memory_map.h"
+#include "supervisor.h"
+#include "trace.h"
+#include "ring.h"
+#include "perf.h"
+#include "xscugic.h"
+#include <arm_acle.h>
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
 
-#define FH_BUFFER_SIZE 4096		// 2MiB: 0x18000000 - 0x18200000
+#define FH_BUFFER_SIZE (MEM_MAP_FH_SIZE / sizeof(FrameHeader_s))
+#define FRAME_FOT_RING_SIZE 16
+#define FRAME_DESC_RING_SIZE 64
+#define FRAME_COMMAND_RING_SIZE 8
 #define FRAME_LB_EXP 9
 
+// Record commands from the UI to the storage core.
+#define FRAME_COMMAND_START	1
+#define FRAME_COMMAND_STOP	2
+
+// Emergency codestream skipping thresholds, as a fraction of DDR buffer fill.
+#define FRAME_CS_SKIP_HH1_FILL		0.50f
+#define FRAME_CS_SKIP_HL1_LH1_FILL	0.75f
+#define FRAME_CS_SKIP_EXIT_FILL		0.25f
+
+// Telemetry sampling.
+#define FRAME_TELEMETRY_PERIOD_US		1000000
+#define FRAME_TELEMETRY_BUFFER_SIZE		(MEM_MAP_TELEMETRY_SIZE / sizeof(TelemetrySample_s))
+#define FRAME_TELEMETRY_BLOCK			64			// 4KiB per write.
+
+// Multi-frame write grouping limits.
+#define FRAME_GROUP_MAX					16
+#define FRAME_GROUP_BYTES				0x400000	// 4MiB
+
+// SSD write model. Consumer NVMe drives slow down sharply once their fast (SLC) write cache fills.
+#define FRAME_SSD_CLIFF_FRACTION		0.5f	// Write rate drop vs. peak that counts as hitting the cliff.
+#define FRAME_SSD_RATE_MARGIN			0.9f	// Fraction of the sustained write rate to plan for.
+#define FRAME_SSD_HORIZON_S				10.0f	// Lead time for raising compression ahead of the cliff.
+#define FRAME_COMPRESSION_TARGET_MIN	5.0f
+#define FRAME_COMPRESSION_TARGET_MAX	10.0f
+
+// SSD thermal model. Acts ahead of the drive's own thermal throttle, which stalls writes.
+#define FRAME_SSD_THERMAL_MARGIN_C		5.0f	// Full mitigation this far below the warning temperature.
+#define FRAME_SSD_THERMAL_HORIZON_S		60.0f	// Start mitigating if the margin is predicted within this time.
+#define FRAME_SSD_THERMAL_EXIT_C		10.0f	// Release once this far below the warning temperature and not rising.
+#define FRAME_SSD_THERMAL_BIAS_MAX		1.5f	// Compression target multiplier at full mitigation.
+
 // Private Type Definitions --------------------------------------------------------------------------------------------
 
+// Encoder state latched at FOT by the top half, for the deferred bottom half.
+typedef struct
+{
+	Encoder_s encoderPrev;		// Before service: ends the just-captured frame.
+	Encoder_s encoderNext;		// After service: starts the upcoming frame.
+	XTime tFrameIn;
+	u32 nFramesLost;			// Overruns since the previous snapshot, merged into the just-captured frame.
+} FrameFOTSnapshot_s;
+
+// Completed frame, passed from the FOT bottom half to the storage core. Its header and codestreams are final.
+typedef struct
+{
+	s32 nFrame;
+} FrameDesc_s;
+
+// Record start or stop, passed from the UI to the storage core.
+typedef struct
+{
+	u32 command;
+	s32 nFrame;					// Frame at which to start or stop.
+} FrameCommand_s;
+
+// Clip Info File Contents [128.5KiB]
+typedef struct __attribute__((packed))
+{
+	ClipHeader_s clipHeader;
+	DarkFrame_s dfCold;
+	DarkFrame_s dfWarm;
+} ClipInfo_s;
+
 // Private Function Prototypes -----------------------------------------------------------------------------------------
 
+void frameBuildHeader(const FrameFOTSnapshot_s * snapshot);
 void frameApplyCameraStateSync(void);
+void frameApplyCommand(const FrameCommand_s * command);
+void frameStageClip(void);
+void frameStartClip(void);
 void frameRecord(void);
+u32 frameGetGroupSize(void);
+void frameUpdateSkipFlags(void);
+void frameUpdateSSDModel(u64 tFileRead_us);
+void frameUpdateSSDThermal(u64 tFileRead_us);
+void frameUpdateTelemetry(u32 tWrite_us, u32 nFrames, XTime tNow);
+void frameFlushTelemetry(void);
 void frameUpdateCompression(const u32 * csSizeBuffer);
 void frameUpdateTemps(void);
 
 // Public Global Variables ---------------------------------------------------------------------------------------------
 
-u8 frameCompressionProfile = 7;
-float frameCompressionRatio = 5.0f;
+OCM_DATA u8 frameCompressionProfile = 7;
+OCM_DATA float frameCompressionRatio = 5.0f;
+OCM_DATA float frameCompressionTarget = FRAME_COMPRESSION_TARGET_MIN;
+u8 frameRecState = FRAME_REC_STATE_IDLE;
+u16 frameCSSkipFlags = 0x0000;
+
+// SSD write model results, zero until measured.
+u64 frameSSDBytesSinceIdle = 0;		// Bytes written since the fast cache was last assumed empty.
+u64 frameSSDCacheBytes = 0;			// Learned fast cache size, zero until the cliff is first seen.
+float frameSSDRateSustained = 0.0f;	// Post-cliff write rate in [B/s].
 
 // Private Global Variables --------------------------------------------------------------------------------------------
 
 // Frame header circular buffer in external DDR4 RAM.
-FrameHeader_s * fhBuffer = (FrameHeader_s *) (0x18000000);
+OCM_DATA FrameHeader_s * fhBuffer = (FrameHeader_s *) (MEM_MAP_FH_BASE);
+
+// Telemetry sample circular buffer in external DDR4 RAM. Sized so that a block is never reused while its
+// write may still be in flight.
+TelemetrySample_s * tmBuffer = (TelemetrySample_s *) (MEM_MAP_TELEMETRY_BASE);
+u32 nTelemetrySamples = 0;
+u32 frameWriteHist[32];			// Frame write latency histogram, bucket n counts latencies up to 2^n [us].
+u32 frameWriteMax_us = 0;
+u32 nFramesTelemetry = 0;
+XTime tTelemetryLast = 0;
+
+// Clip info file contents staged in external DDR4 RAM while in standby.
+ClipInfo_s * ciBuffer = (ClipInfo_s *) (MEM_MAP_CLIP_INFO_BASE);
+DarkFrame_s * ciStagedDarkFrame = NULL;
+
+OCM_DATA u32 nSubframesIn = 0xFFFFFFFF;
+OCM_DATA s32 nFramesIn = -1;
+
+// FOT snapshot ring, filled by isrFOT() and drained by isrFOTDeferred().
+OCM_DATA FrameFOTSnapshot_s fotRing[FRAME_FOT_RING_SIZE];
+OCM_DATA volatile u32 nFOTIn = 0;
+OCM_DATA volatile u32 nFOTOut = 0;
+OCM_DATA u32 nFOTOverruns = 0;
+OCM_DATA u32 nFOTLostPending = 0;	// Overruns not yet carried by a snapshot. isrFOT() only.
+OCM_DATA Encoder_s fotOverrunSnapshot;
+
+// Core 0 to storage core rings. nFramesQueued is the storage core's view of nFramesIn.
+OCM_DATA FrameDesc_s frameDescSlots[FRAME_DESC_RING_SIZE];
+OCM_DATA Ring_s frameDescRing;
+OCM_DATA FrameCommand_s frameCommandSlots[FRAME_COMMAND_RING_SIZE];
+OCM_DATA Ring_s frameCommandRing;
+s32 nFramesQueued = 0;
+
+// Performance counters.
+OCM_DATA PerfCounter_s * perfFIFOFill;
+PerfCounter_s * perfRecLatency;
+PerfCounter_s * perfRecWrite;
+PerfCounter_s * perfRecBacklog;
+PerfCounter_s * perfRecCRC;
 
-u32 nSubframesIn = 0xFFFFFFFF;
-s32 nFramesIn = -1;
 s32 nFramesOutStart = 0;
 s32 nFramesOut = 0;
+s32 nFramesOutStop = 0;
+
+// Clip start requested while the previous clip is still finalizing.
+s32 nFramesOutStartNext = 0;
+u8 frameRecStartPending = 0;
 
 u32 nFramesPerFile = 481;
-u32 nSubframesPerFrame = 1;
+OCM_DATA u32 nSubframesPerFrame = 1;
 
 u32 nFramesPerFileSync = 481;
 u32 nSubframesPerFrameSync = 1;
-u32 frameApplyCameraStateSyncFlag = 0;
+OCM_DATA u32 frameApplyCameraStateSyncFlag = 0;
 
 s8 frameTempPS = 0x00;
 s8 frameTempPL = 0x00;
 s8 frameTempCMV = 0x00;
 s8 frameTempSSD = 0x00;
 
+// SSD write model state. Rates are in [B/s], zero until measured.
+u64 frameSSDFileBytes = 0;			// Bytes written to the current file.
+u64 frameSSDFileBusy_us = 0;		// SSD write time in frameRecord() for the current file, excluding checksums.
+u64 frameSSDFileRead_us = 0;		// Read-in time of the first frame of the current file.
+XTime tSSDIdle = 0;
+float frameSSDRatePeak = 0.0f;
+float frameSSDLatency_us = 0.0f;	// Mean per-frame write latency for the last file.
+
+// SSD thermal model state.
+float frameSSDTemp = 0.0f;			// Unclamped SSD temperature in [C].
+float frameSSDTempLast = 0.0f;
+u64 frameSSDTempLast_us = 0;
+float frameSSDTempSlope = 0.0f;		// Smoothed SSD temperature slope in [C/s].
+float frameSSDThermalBias = 1.0f;	// Compression target multiplier.
+u8 frameSSDThermalActive = 0;
+u8 frameSSDFanRestore = SUPERVISOR_FAN_HIGH;
+
 // Interrupt Handlers --------------------------------------------------------------------------------------------------
 
 /*
-Frame Overhead Time (FOT) Interrupt Service Routine
+Frame Overhead Time (FOT) Interrupt Service Routine (Top Half)
 - Interrupt flag set by rising edge of FOT bit signal on the CMV12000 control channel.
 - Interrupt flag cleared by software.
-- Constructs frame headers in an external DDR4 buffer. DDR4 access does not compete with frame read-in if
-  the ISR returns before the end of the FOT period, which lasts about 20-30us.
+- Services the encoder and latches its state and a timestamp into the FOT snapshot ring. Must return before the
+  end of the FOT period, which lasts about 20-30us. Everything else is deferred to isrFOTDeferred().
 */
-void isrFOT(void * CallbackRef)
+OCM_TEXT void isrFOT(void * CallbackRef)
 {
-	Encoder_s Encoder_prev, Encoder_next;
-	XTime tFrameIn;
-	u32 iFrameIn;
-	u32 csSizeBuffer[16];
+	FrameFOTSnapshot_s * snapshot;
 
 	nSubframesIn++;
 	CMV_Input->FOT_int = 0x00000000;			// Clear the FOT interrupt flag.
 
 	if(nSubframesIn % nSubframesPerFrame > 0) { return; }
 
-	XGpioPs_WritePin(&Gpio, GPIO1_PIN, 1);		// Mark ISR entry.
-
-	// Time-critical Encoder access. Must complete before end of FOT.
-	memcpy(&Encoder_prev, Encoder, sizeof(Encoder_s));
-	encoderServiceFOT(&Encoder_prev, frameCompressionProfile);
-	memcpy(&Encoder_next, Encoder, sizeof(Encoder_s));
-	XGpioPs_WritePin(&Gpio, GPIO1_PIN, 0);		// Mark time-critical exit.
+	traceEvent(TRACE_FOT_ENTER, nSubframesIn);
 
-	// Record information for the just-captured frame (if one exists).
-	if(nFramesIn >= 0)
+	if((nFOTIn - nFOTOut) >= FRAME_FOT_RING_SIZE)
 	{
-		iFrameIn = nFramesIn % FH_BUFFER_SIZE;
-		for(int iCS = 0; iCS < 16; iCS++)
-		{
-			// Codestream size.
-			csSizeBuffer[iCS] = Encoder_prev.c_RAM_addr[iCS] - fhBuffer[iFrameIn].csAddr[iCS];
-		}
+		// The bottom half is a full ring behind. The encoder must still be serviced, but this snapshot is lost. The
+		// lost frame's codestreams run on into the next one, and the next snapshot carries the count to its header.
+		memcpy(&fotOverrunSnapshot, Encoder, sizeof(Encoder_s));
+		encoderServiceFOT(&fotOverrunSnapshot, frameCompressionProfile);
+		nFOTOverruns++;
+		nFOTLostPending++;
+		traceEvent(TRACE_FOT_EXIT, nFOTOverruns);
+		return;
 	}
-	memcpy(fhBuffer[iFrameIn].csSize, csSizeBuffer, 16 * sizeof(u32));
 
-	// Increment the input frame counter.
-	nFramesIn++;
-	iFrameIn = nFramesIn % FH_BUFFER_SIZE;
+	snapshot = &fotRing[nFOTIn % FRAME_FOT_RING_SIZE];
 
-	// Wipe old data.
-	memset(&fhBuffer[iFrameIn], 0, 512);
-
-	// Time and index stamp the upcoming frame.
-	XTime_GetTime(&tFrameIn);
-	fhBuffer[iFrameIn].tFrameRead_us = tFrameIn * US_PER_COUNT;
-	fhBuffer[iFrameIn].nFrame = nFramesIn;
+	// Time-critical Encoder access. Must complete before end of FOT.
+	memcpy(&snapshot->encoderPrev, Encoder, sizeof(Encoder_s));
+	encoderServiceFOT(&snapshot->encoderPrev, frameCompressionProfile);
+	memcpy(&snapshot->encoderNext, Encoder, sizeof(Encoder_s));
+	traceEvent(TRACE_FOT_CRITICAL_EXIT, 0);
 
-	// Frame delimeter and quick info for the upcoming frame.
-	memcpy(fhBuffer[iFrameIn].strDelimiter, "WAVE HELLO!\n",12);
-	fhBuffer[iFrameIn].wFrame = (u16)(cState.cSetting[CSETTING_WIDTH]->valArray[cState.cSetting[CSETTING_WIDTH]->val].fVal);
-	fhBuffer[iFrameIn].hFrame = (u16)(cState.cSetting[CSETTING_HEIGHT]->valArray[cState.cSetting[CSETTING_HEIGHT]->val].fVal);;
+	XTime_GetTime(&snapshot->tFrameIn);
+	snapshot->nFramesLost = nFOTLostPending;
+	nFOTLostPending = 0;
+	nFOTIn++;
 
-	// Quantizer settings for the upcoming frame.
-	// TO-DO: Right here is where the quantizer settings should be modified to hit bit rate target!
-	fhBuffer[iFrameIn].q_mult_HH1_HL1_LH1 = Encoder_next.q_mult_HH1_HL1_LH1;
-	fhBuffer[iFrameIn].q_mult_HH2_HL2_LH2 = Encoder_next.q_mult_HH2_HL2_LH2;
+	// Header assembly and rate control run in the low-priority bottom half.
+	XScuGic_SoftwareIntr((XScuGic *) CallbackRef, FRAME_FOT_SGI, XSCUGIC_SPI_CPU0_MASK);
 
-	// Codestream start addresses and FIFO state for the upcoming frame.
-	fhBuffer[iFrameIn].csFIFOFlags = Encoder_next.fifo_flags;
-	for(int iCS = 0; iCS < 16; iCS++)
-	{
-		fhBuffer[iFrameIn].csAddr[iCS] = Encoder_next.c_RAM_addr[iCS];
-		fhBuffer[iFrameIn].csFIFOState[iCS] = Encoder_next.fifo_rd_count[iCS];
-	}
+	traceEvent(TRACE_FOT_EXIT, 0);
+}
 
-	// Check the compressed frame size and update quantization profile as-needed.
-	frameUpdateCompression(csSizeBuffer);
+/*
+Frame Overhead Time (FOT) Deferred Interrupt Service Routine (Bottom Half)
+- Software-generated interrupt raised by isrFOT(), below the sensor, video, GPIO, and IMU interrupts.
+- Builds the frame headers and updates rate control for every latched FOT snapshot, oldest first. Runs
+  once any higher-priority interrupts are served, so its deadline is bounded by the snapshot ring size,
+  not by the main loop.
+*/
+OCM_TEXT void isrFOTDeferred(void * CallbackRef)
+{
+	traceEvent(TRACE_FOT_BH_ENTER, nFOTIn - nFOTOut);
 
-	// Apply camera state settings to the frame module.
-	if(frameApplyCameraStateSyncFlag)
+	while(nFOTOut != nFOTIn)
 	{
-		frameApplyCameraStateSync();
+		frameBuildHeader(&fotRing[nFOTOut % FRAME_FOT_RING_SIZE]);
+		nFOTOut++;
 	}
 
-	// XGpioPs_WritePin(&Gpio, GPIO1_PIN, 0);		// Mark ISR exit.
+	traceEvent(TRACE_FOT_BH_EXIT, 0);
 }
 
 // Public Function Definitions -----------------------------------------------------------------------------------------
 
 void frameInit(void)
 {
+	ClipHeader_s * clipHeader = &ciBuffer->clipHeader;
+
+	// Constant fields of the staged clip header.
+	memset(clipHeader, 0, sizeof(ClipHeader_s));
+	memcpy(clipHeader->strDelimiter, "WAVE HELLO!\n",12);
+	clipHeader->version.major = 0;									// TO-DO: Pull from firmware version?
+	clipHeader->version.minor = 0;
+	clipHeader->version.build = 0;
+	clipHeader->hdrTExp1 = 0.050f;									// TO-DO: Drive these from somewhere.
+	clipHeader->hdrKp1 = 0.068f;
+	clipHeader->hdrKp1Window = 0.010f;
+	clipHeader->hdrTExp2 = 0.021f;
+	clipHeader->hdrKp2 = 0.080f;
+	clipHeader->hdrKp2Window = 0.005f;
+	clipHeader->imuSampleRate = IMU_SAMPLE_RATE_HZ;
+	clipHeader->imuGyroRange = IMU_GYRO_RANGE_DPS;
+	clipHeader->imuAccelRange = IMU_ACCEL_RANGE_G;
+
+	ringInit(&frameDescRing, frameDescSlots, FRAME_DESC_RING_SIZE, sizeof(FrameDesc_s));
+	perfFIFOFill = perfRegister("enc.fifo", "words");
+	perfRecLatency = perfRegister("rec.latency", "us");
+	perfRecWrite = perfRegister("rec.write", "us");
+	perfRecBacklog = perfRegister("rec.backlog", "frames");
+	perfRecCRC = perfRegister("rec.crc", "us");
+	ringInit(&frameCommandRing, frameCommandSlots, FRAME_COMMAND_RING_SIZE, sizeof(FrameCommand_s));
+
 	CMV_Input->FRAME_REQ_on = 0;
 	frameApplyCameraState();
 	frameApplyCameraStateSync();
@@ -190,68 +353,232 @@ void frameApplyCameraState(void)
 
 void frameCreateClip(void)
 {
-	ClipHeader_s clipHeader;
+	FrameCommand_s command;
 
 	XGpioPs_WritePin(&Gpio, REC_LED_PIN, 1);
-	fsCreateClip();
-
-	// Build the clip header.
-	memcpy(clipHeader.strDelimiter, "WAVE HELLO!\n",12);
-	clipHeader.version.major = 0;									// TO-DO: Pull from firmware version?
-	clipHeader.version.minor = 0;
-	clipHeader.version.build = 0;
-	clipHeader.wFrame = (u16)(cState.cSetting[CSETTING_WIDTH]->valArray[cState.cSetting[CSETTING_WIDTH]->val].fVal);
-	clipHeader.hFrame = (u16)(cState.cSetting[CSETTING_HEIGHT]->valArray[cState.cSetting[CSETTING_HEIGHT]->val].fVal);
-	clipHeader.fps = cState.cSetting[CSETTING_FPS]->valArray[cState.cSetting[CSETTING_FPS]->val].fVal;
-	clipHeader.shutterAngle = cState.cSetting[CSETTING_SHUTTER]->valArray[cState.cSetting[CSETTING_SHUTTER]->val].fVal;
-	clipHeader.colorTemp = cState.cSetting[CSETTING_COLOR]->valArray[cState.cSetting[CSETTING_COLOR]->val].fVal;
-	clipHeader.gain = (u8)(cState.cSetting[CSETTING_GAIN]->valArray[cState.cSetting[CSETTING_GAIN]->val].fVal);
-	memcpy(&clipHeader.m5600K, &m5600K, sizeof(LUT1DMatrix_s));
-	memcpy(&clipHeader.m3200K, &m3200K, sizeof(LUT1DMatrix_s));
-	clipHeader.hdrTExp1 = 0.050f;									// TO-DO: Drive these from somewhere.
-	clipHeader.hdrKp1 = 0.068f;
-	clipHeader.hdrKp1Window = 0.010f;
-	clipHeader.hdrTExp2 = 0.021f;
-	clipHeader.hdrKp2 = 0.080f;
-	clipHeader.hdrKp2Window = 0.005f;
-	memcpy(&clipHeader.cmvSettings, &CMV_Settings_W, sizeof(CMV_Settings_s));
-
-	// Write the clip header and dark frames to the clip info file.
-	fsWriteClipInfo((u64)(&clipHeader), sizeof(ClipHeader_s));
-	fsWriteClipInfo((u64)dfCold, sizeof(DarkFrame_s));
-	fsWriteClipInfo((u64)dfWarm, sizeof(DarkFrame_s));
-	fsCloseClipInfo();
 
-	// Start recording at the current frame.
-	nFramesOutStart = nFramesIn;
-	nFramesOut = nFramesOutStart;
+	// Start recording at the current frame. Applied by the storage core.
+	command.command = FRAME_COMMAND_START;
+	command.nFrame = nFramesIn;
+	ringPush(&frameCommandRing, &command);
 }
 
+// Storage core only.
 void frameAddToClip(void)
 {
-	if(nFramesOut + 3 < nFramesIn) { frameRecord(); }
+	int nClipClosed;
+	FrameDesc_s desc;
+	FrameCommand_s command;
+
+	while(ringPop(&frameDescRing, &desc)) { nFramesQueued = desc.nFrame + 1; }
+	while(ringPop(&frameCommandRing, &command)) { frameApplyCommand(&command); }
+
+	switch(frameRecState)
+	{
+	case FRAME_REC_STATE_START:
+		frameStartClip();
+		frameRecState = FRAME_REC_STATE_CONTINUE;
+		break;
+	case FRAME_REC_STATE_CONTINUE:
+		if(nFramesOut + 3 < nFramesQueued) { frameRecord(); }
+		else { fsServiceSync(1); }		// Caught up: commit file size and FAT state in frame slack time.
+		break;
+	case FRAME_REC_STATE_FINALIZE:
+		if(nFramesOut < nFramesOutStop)
+		{
+			// Drain the backlog up to the frame where recording was stopped.
+			if(nFramesOut + 3 < nFramesQueued) { frameRecord(); }
+		}
+		else
+		{
+			// Backlog is empty. Truncate, close, and index the clip, then queue it for read-back verification.
+			nClipClosed = nClip;
+			frameFlushTelemetry();
+			fsCloseClip();
+			verifyStartClip(nClipClosed);
+			XTime_GetTime(&tSSDIdle);
+			if(frameRecStartPending)
+			{
+				frameRecStartPending = 0;
+				frameRecState = FRAME_REC_STATE_START;
+			}
+			else
+			{
+				frameRecState = FRAME_REC_STATE_IDLE;
+			}
+		}
+		break;
+	case FRAME_REC_STATE_IDLE:
+	default:
+		frameStageClip();
+		verifyService();	// Yields the SSD as soon as REC leaves the idle state.
+		break;
+	}
 }
 
 void frameCloseClip(void)
 {
-	fsCloseClip();
+	FrameCommand_s command;
+
 	XGpioPs_WritePin(&Gpio, REC_LED_PIN, 0);
+
+	// Stop at the current frame. Applied by the storage core.
+	command.command = FRAME_COMMAND_STOP;
+	command.nFrame = nFramesIn;
+	ringPush(&frameCommandRing, &command);
+}
+
+u32 frameGetBacklog(void)
+{
+	switch(frameRecState)
+	{
+	case FRAME_REC_STATE_CONTINUE:
+		return (u32)(nFramesQueued - nFramesOut);
+	case FRAME_REC_STATE_FINALIZE:
+		return (u32)(nFramesOutStop - nFramesOut);
+	default:
+		return 0;
+	}
+}
+
+// Recording work is waiting: a clip is open or finalizing, or a record command has not been applied yet.
+u8 frameRecordPending(void)
+{
+	return (frameRecState != FRAME_REC_STATE_IDLE) || (ringCount(&frameCommandRing) > 0);
 }
 
-int frameLastCapturedIndex(void)
+OCM_TEXT int frameLastCapturedIndex(void)
 {
 	if(nFramesIn < 1) { return -1; }
 
 	return (nFramesIn - 1) % FH_BUFFER_SIZE;
 }
 
-FrameHeader_s * frameGetHeader(u32 iFrame)
+OCM_TEXT FrameHeader_s * frameGetHeader(u32 iFrame)
 {
 	return (FrameHeader_s *)(&fhBuffer[iFrame % FH_BUFFER_SIZE]);
 }
 
 // Private Function Definitions ----------------------------------------------------------------------------------------
 
+// Build the frame header for the upcoming frame from a FOT snapshot, and complete the just-captured one.
+OCM_TEXT void frameBuildHeader(const FrameFOTSnapshot_s * snapshot)
+{
+	u32 iFrameIn;
+	u32 csSizeBuffer[16];
+	u16 fifoFillMax = 0;
+	FrameDesc_s desc;
+
+	// Record information for the just-captured frame (if one exists).
+	memset(csSizeBuffer, 0, 16 * sizeof(u32));
+	if(nFramesIn >= 0)
+	{
+		iFrameIn = nFramesIn % FH_BUFFER_SIZE;
+		for(int iCS = 0; iCS < 16; iCS++)
+		{
+			// Codestream size.
+			csSizeBuffer[iCS] = snapshot->encoderPrev.c_RAM_addr[iCS] - fhBuffer[iFrameIn].csAddr[iCS];
+		}
+		memcpy(fhBuffer[iFrameIn].csSize, csSizeBuffer, 16 * sizeof(u32));
+
+		// Frames lost to FOT overruns since this one started are part of its codestreams.
+		if(snapshot->nFramesLost > 255) { fhBuffer[iFrameIn].nFramesLost = 255; }
+		else { fhBuffer[iFrameIn].nFramesLost = (u8) snapshot->nFramesLost; }
+	}
+
+	// Wipe old data.
+	iFrameIn = (nFramesIn + 1) % FH_BUFFER_SIZE;
+	memset(&fhBuffer[iFrameIn], 0, 512);
+
+	// Time and index stamp the upcoming frame.
+	fhBuffer[iFrameIn].tFrameRead_us = snapshot->tFrameIn * US_PER_COUNT;
+	fhBuffer[iFrameIn].nFrame = nFramesIn + 1;
+
+	// Start the IMU FIFO burst read. It completes into this frame's header in the background.
+	imuServiceFOT(&fhBuffer[iFrameIn].imu, fhBuffer[iFrameIn].tFrameRead_us);
+
+	// Frame delimeter and quick info for the upcoming frame.
+	memcpy(fhBuffer[iFrameIn].strDelimiter, "WAVE HELLO!\n",12);
+	fhBuffer[iFrameIn].wFrame = (u16)(cState.cSetting[CSETTING_WIDTH]->valArray[cState.cSetting[CSETTING_WIDTH]->val].fVal);
+	fhBuffer[iFrameIn].hFrame = (u16)(cState.cSetting[CSETTING_HEIGHT]->valArray[cState.cSetting[CSETTING_HEIGHT]->val].fVal);;
+
+	// Quantizer settings for the upcoming frame.
+	fhBuffer[iFrameIn].q_mult_HH1_HL1_LH1 = snapshot->encoderNext.q_mult_HH1_HL1_LH1;
+	fhBuffer[iFrameIn].q_mult_HH2_HL2_LH2 = snapshot->encoderNext.q_mult_HH2_HL2_LH2;
+	fhBuffer[iFrameIn].nWaveletStages = WAVELET_NUM_STAGES;
+
+	// Codestream start addresses and FIFO state for the upcoming frame.
+	fhBuffer[iFrameIn].csFIFOFlags = snapshot->encoderNext.fifo_flags;
+	for(int iCS = 0; iCS < 16; iCS++)
+	{
+		fhBuffer[iFrameIn].csAddr[iCS] = snapshot->encoderNext.c_RAM_addr[iCS];
+		fhBuffer[iFrameIn].csFIFOState[iCS] = snapshot->encoderNext.fifo_rd_count[iCS];
+		if(snapshot->encoderNext.fifo_rd_count[iCS] > fifoFillMax) { fifoFillMax = snapshot->encoderNext.fifo_rd_count[iCS]; }
+	}
+	perfSample(perfFIFOFill, fifoFillMax);
+
+	// The upcoming frame's header is complete. Publish it, and pass the just-captured one to the storage core.
+	nFramesIn++;
+	if(nFramesIn > 0)
+	{
+		desc.nFrame = nFramesIn - 1;
+		ringPush(&frameDescRing, &desc);
+	}
+
+	// Check the compressed frame size and update quantization profile as-needed.
+	frameUpdateCompression(csSizeBuffer);
+
+	// Apply camera state settings to the frame module.
+	if(frameApplyCameraStateSyncFlag)
+	{
+		frameApplyCameraStateSync();
+	}
+}
+
+void frameApplyCommand(const FrameCommand_s * command)
+{
+	switch(command->command)
+	{
+	case FRAME_COMMAND_START:
+		nFramesOutStartNext = command->nFrame;
+		if(frameRecState == FRAME_REC_STATE_FINALIZE)
+		{
+			// The previous clip is still being finalized. Defer file system access until it's closed.
+			frameRecStartPending = 1;
+		}
+		else
+		{
+			// File system access is deferred to frameAddToClip(), using the clip staged in standby.
+			frameRecState = FRAME_REC_STATE_START;
+		}
+		break;
+	case FRAME_COMMAND_STOP:
+		if(frameRecState == FRAME_REC_STATE_IDLE)
+		{
+			// No clip open, nothing to stop.
+			break;
+		}
+		if(frameRecState == FRAME_REC_STATE_START)
+		{
+			// Clip was never opened, nothing to finalize.
+			frameRecState = FRAME_REC_STATE_IDLE;
+			break;
+		}
+		if(frameRecState == FRAME_REC_STATE_FINALIZE)
+		{
+			// Already stopping, keep the original stop frame. Only a deferred clip start can be cancelled.
+			frameRecStartPending = 0;
+			break;
+		}
+		// The backlog is drained and the clip is closed by frameAddToClip().
+		nFramesOutStop = command->nFrame;
+		frameRecState = FRAME_REC_STATE_FINALIZE;
+		break;
+	default:
+		break;
+	}
+}
+
 void frameApplyCameraStateSync(void)
 {
 	nSubframesPerFrame = nSubframesPerFrameSync;
@@ -259,58 +586,479 @@ void frameApplyCameraStateSync(void)
 	frameApplyCameraStateSyncFlag = 0;
 }
 
+void frameStageClip(void)
+{
+	// Create the next clip directory and open its clip info file ahead of time.
+	fsStageClip();
+
+	// Dark frames only change with width, copy them out of flash when they do.
+	if((dfCold == NULL) || (ciStagedDarkFrame == dfCold)) { return; }
+
+	memcpy(&ciBuffer->dfCold, dfCold, sizeof(DarkFrame_s));
+	memcpy(&ciBuffer->dfWarm, dfWarm, sizeof(DarkFrame_s));
+	ciStagedDarkFrame = dfCold;
+}
+
+void frameStartClip(void)
+{
+	ClipHeader_s * clipHeader = &ciBuffer->clipHeader;
+	XTime tNow;
+	u64 bytesRecovered;
+
+	// Opens the staged clip, or creates it now if staging hasn't happened yet.
+	fsCreateClip();
+	frameStageClip();
+
+	// Patch the staged clip header with settings that can change in standby.
+	clipHeader->wFrame = (u16)(cState.cSetting[CSETTING_WIDTH]->valArray[cState.cSetting[CSETTING_WIDTH]->val].fVal);
+	clipHeader->hFrame = (u16)(cState.cSetting[CSETTING_HEIGHT]->valArray[cState.cSetting[CSETTING_HEIGHT]->val].fVal);
+	clipHeader->fps = cState.cSetting[CSETTING_FPS]->valArray[cState.cSetting[CSETTING_FPS]->val].fVal;
+	clipHeader->shutterAngle = cState.cSetting[CSETTING_SHUTTER]->valArray[cState.cSetting[CSETTING_SHUTTER]->val].fVal;
+	clipHeader->colorTemp = cState.cSetting[CSETTING_COLOR]->valArray[cState.cSetting[CSETTING_COLOR]->val].fVal;
+	clipHeader->gain = (u8)(cState.cSetting[CSETTING_GAIN]->valArray[cState.cSetting[CSETTING_GAIN]->val].fVal);
+	memcpy(&clipHeader->m5600K, &m5600K, sizeof(LUT1DMatrix_s));
+	memcpy(&clipHeader->m3200K, &m3200K, sizeof(LUT1DMatrix_s));
+	memcpy(&clipHeader->cmvSettings, &CMV_Settings_W, sizeof(CMV_Settings_s));
+
+	// Write the staged clip header and dark frames to the clip info file in one transfer.
+	fsWriteClipInfo((u64)ciBuffer, sizeof(ClipInfo_s));
+	fsCloseClipInfo();
+
+	// Start recording at the frame latched by frameCreateClip().
+	nFramesOutStart = nFramesOutStartNext;
+	nFramesOut = nFramesOutStart;
+
+	// The SSD drains its fast cache while idle, assumed at about its sustained rate. Without a
+	// sustained rate measurement, assume any idle time is enough to empty it.
+	XTime_GetTime(&tNow);
+	if(frameSSDRateSustained > 0.0f)
+	{
+		bytesRecovered = (u64)(frameSSDRateSustained * (float)(tNow - tSSDIdle) / (float)COUNTS_PER_SECOND);
+		if(bytesRecovered < frameSSDBytesSinceIdle) { frameSSDBytesSinceIdle -= bytesRecovered; }
+		else { frameSSDBytesSinceIdle = 0; }
+	}
+	else
+	{ frameSSDBytesSinceIdle = 0; }
+
+	// The SSD temperature slope restarts with the clip.
+	frameSSDTempLast_us = 0;
+	frameSSDTempSlope = 0.0f;
+
+	frameSSDFileBytes = 0;
+	frameSSDFileBusy_us = 0;
+
+	// Start a new telemetry stream.
+	nTelemetrySamples = 0;
+	memset(frameWriteHist, 0, sizeof(frameWriteHist));
+	frameWriteMax_us = 0;
+	nFramesTelemetry = 0;
+	tTelemetryLast = tNow;
+	mainResetDDRQueueMax();
+}
+
 void frameRecord(void)
 {
-	XTime tFrameOut;
-	u32 iFrameOut;
+	XTime tFrameOut, tFrameOutDone;
+	XTime tCRCStart, tCRCEnd;
+	XTime tCRC = 0;
+	u32 tWrite_us;
+	u32 iFrameOut, iFrame;
+	u32 nGroup;
 	u32 csAddrBuffer[16];
 	u32 csSizeBuffer[16];
 
-	// XGpioPs_WritePin(&Gpio, GPIO2_PIN, 1);		// Mark frame recorder entry.
+	traceEvent(TRACE_REC_ENTER, nFramesOut);
+	perfSample(perfRecBacklog, nFramesQueued - nFramesOut);
 
-	// Fill in write-time frame header data.
 	XTime_GetTime(&tFrameOut);
 	iFrameOut = nFramesOut % FH_BUFFER_SIZE;
-	fhBuffer[iFrameOut].nFrameBacklog = nFramesIn - nFramesOut;
-	fhBuffer[iFrameOut].tFrameWrite_us = tFrameOut * US_PER_COUNT;
 
-	// Fill in temperature sensor data.
-	fhBuffer[iFrameOut].tempPS = frameTempPS;
-	fhBuffer[iFrameOut].tempPL = frameTempPL;
-	fhBuffer[iFrameOut].tempCMV = frameTempCMV;
-	fhBuffer[iFrameOut].tempSSD = frameTempSSD;
+	// Group small, contiguous frames into fewer, larger writes. Must be sized before skipping codestreams.
+	nGroup = frameGetGroupSize();
+
+	// Skip high-pass codestreams if the SSD has fallen too far behind. Skipped codestreams are logged with
+	// zero size so the file stays self-consistent and the decoder treats those subbands as zero.
+	frameUpdateSkipFlags();
+
+	memset(csSizeBuffer, 0, 16 * sizeof(u32));
+	for(u32 n = 0; n < nGroup; n++)
+	{
+		iFrame = iFrameOut + n;
+
+		// Fill in write-time frame header data.
+		fhBuffer[iFrame].nFrameBacklog = nFramesQueued - nFramesOut - n;
+		fhBuffer[iFrame].tFrameWrite_us = tFrameOut * US_PER_COUNT;
+		fhBuffer[iFrame].nFramesGrouped = (u8) nGroup;
+		fhBuffer[iFrame].iFrameGrouped = (u8) n;
+		perfSample(perfRecLatency, (u32)(fhBuffer[iFrame].tFrameWrite_us - fhBuffer[iFrame].tFrameRead_us));
+
+		// Fill in temperature sensor data.
+		fhBuffer[iFrame].tempPS = frameTempPS;
+		fhBuffer[iFrame].tempPL = frameTempPL;
+		fhBuffer[iFrame].tempCMV = frameTempCMV;
+		fhBuffer[iFrame].tempSSD = frameTempSSD;
+
+		if(frameCSSkipFlags)
+		{
+			fhBuffer[iFrame].csSkipFlags = frameCSSkipFlags;
+			for(int iCS = 0; iCS < 16; iCS++)
+			{
+				if(frameCSSkipFlags & (1 << iCS)) { fhBuffer[iFrame].csSize[iCS] = 0; }
+			}
+		}
+
+		// Codestream checksums, stored in the header for offload and recovery verification. These read the whole
+		// frame from non-cacheable DDR4, so the per-frame cost is counted against the frame period. It's kept out of
+		// the write time below, which feeds the SSD model.
+		XTime_GetTime(&tCRCStart);
+		for(int iCS = 0; iCS < 16; iCS++)
+		{
+			fhBuffer[iFrame].csCRC32C[iCS] = frameCRC32C(fhBuffer[iFrame].csAddr[iCS], fhBuffer[iFrame].csSize[iCS]);
+			csSizeBuffer[iCS] += fhBuffer[iFrame].csSize[iCS];
+		}
+		XTime_GetTime(&tCRCEnd);
+		tCRC += tCRCEnd - tCRCStart;
+		perfSample(perfRecCRC, (tCRCEnd - tCRCStart) * US_PER_COUNT);
+	}
 
-	// Copy the codestream addresses and sizes once to minimize DDR access.
+	// Codestreams for the group start at the first frame's addresses.
 	memcpy(csAddrBuffer, fhBuffer[iFrameOut].csAddr, 16 * sizeof(u32));
-	memcpy(csSizeBuffer, fhBuffer[iFrameOut].csSize, 16 * sizeof(u32));
 
 	if(((nFramesOut - nFramesOutStart) % nFramesPerFile) == 0)
 	{
 		nvmeGetMetrics();	// Sample SSD metrics (incl. temperature).
 		frameUpdateTemps();	// Update temperature sensor frame header-logged values.
+		frameUpdateSSDThermal(fhBuffer[iFrameOut].tFrameRead_us);
+		frameUpdateSSDModel(fhBuffer[iFrameOut].tFrameRead_us);
 		fsCreateFile();		// Create a new file in the clip.
 	}
 
-	// Write frame header.
-	fsWriteFile((u64)(&fhBuffer[iFrameOut]), 512);
+	traceEvent(TRACE_REC_PREP, nGroup);
 
-	// Write codestream data.
+	// Write frame header(s).
+	fsWriteFile((u64)(&fhBuffer[iFrameOut]), 512 * nGroup);
+	traceEvent(TRACE_REC_HEADERS, 0);
+
+	// Write codestream data, each codestream for all frames in the group at once.
+	frameSSDFileBytes += 512 * nGroup;
 	for(int iCS = 0; iCS < 16; iCS++)
 	{
 		fsWriteFile((u64) csAddrBuffer[iCS], csSizeBuffer[iCS]);
+		frameSSDFileBytes += csSizeBuffer[iCS];
 	}
 
-	nFramesOut++;
+	nFramesOut += nGroup;
+
+	XTime_GetTime(&tFrameOutDone);
+	tWrite_us = (tFrameOutDone - tFrameOut - tCRC) * US_PER_COUNT;
+	frameSSDFileBusy_us += tWrite_us;
+	perfSample(perfRecWrite, tWrite_us);
+	frameUpdateTelemetry(tWrite_us, nGroup, tFrameOutDone);
+
+	// Bound the loss window even if the recorder never catches up.
+	fsServiceSync(0);
+
+	traceEvent(TRACE_REC_EXIT, 0);
+}
+
+// Number of frames, starting at nFramesOut, that can be written as a group. Frames are grouped only if
+// they are already in the backlog, stay within one file and one pass of the frame header buffer, and each
+// codestream continues where the previous frame's left off (no codestream buffer wrap).
+u32 frameGetGroupSize(void)
+{
+	u32 nGroupMax, nGroup;
+	u32 iFrameOut, iFrame;
+	u32 szFrame, szGroup;
+	s32 nFramesReady;
+
+	iFrameOut = nFramesOut % FH_BUFFER_SIZE;
+
+	nFramesReady = nFramesQueued - 3 - nFramesOut;
+	if((frameRecState == FRAME_REC_STATE_FINALIZE) && (nFramesOutStop - nFramesOut < nFramesReady))
+	{ nFramesReady = nFramesOutStop - nFramesOut; }
+	if(nFramesReady <= 1) { return 1; }
+
+	nGroupMax = FRAME_GROUP_MAX;
+	if((u32) nFramesReady < nGroupMax) { nGroupMax = nFramesReady; }
+	if(nFramesPerFile - ((nFramesOut - nFramesOutStart) % nFramesPerFile) < nGroupMax)
+	{ nGroupMax = nFramesPerFile - ((nFramesOut - nFramesOutStart) % nFramesPerFile); }
+	if(FH_BUFFER_SIZE - iFrameOut < nGroupMax) { nGroupMax = FH_BUFFER_SIZE - iFrameOut; }
+
+	szGroup = 0;
+	for(int iCS = 0; iCS < 16; iCS++) { szGroup += fhBuffer[iFrameOut].csSize[iCS]; }
+
+	for(nGroup = 1; nGroup < nGroupMax; nGroup++)
+	{
+		iFrame = iFrameOut + nGroup;
+
+		szFrame = 0;
+		for(int iCS = 0; iCS < 16; iCS++)
+		{
+			if(fhBuffer[iFrame - 1].csAddr[iCS] + fhBuffer[iFrame - 1].csSize[iCS] != fhBuffer[iFrame].csAddr[iCS])
+			{ return nGroup; }
+			szFrame += fhBuffer[iFrame].csSize[iCS];
+		}
+
+		if(szGroup + szFrame > FRAME_GROUP_BYTES) { return nGroup; }
+		szGroup += szFrame;
+	}
+
+	return nGroup;
+}
+
+void frameUpdateSkipFlags(void)
+{
+	float fill, fillFH;
+	u32 iFrameOut, iFrameLast;
+
+	// Codestream RAM fill between the next frame out and the last complete frame in. The header for the
+	// last complete frame is not touched by isrFOT until the buffer wraps.
+	iFrameOut = nFramesOut % FH_BUFFER_SIZE;
+	iFrameLast = (nFramesQueued - 1) % FH_BUFFER_SIZE;
+	fill = encoderGetRAMFill(fhBuffer[iFrameOut].csAddr, fhBuffer[iFrameLast].csAddr);
+
+	// Frame header buffer fill.
+	fillFH = (float)(nFramesQueued - nFramesOut) / (float)FH_BUFFER_SIZE;
+	if(fillFH > fill) { fill = fillFH; }
+
+	// Escalate immediately, recover with hysteresis.
+	if(fill >= FRAME_CS_SKIP_HL1_LH1_FILL)
+	{ frameCSSkipFlags = FRAME_CS_SKIP_HH1 | FRAME_CS_SKIP_HL1_LH1; }
+	else if(fill >= FRAME_CS_SKIP_HH1_FILL)
+	{ frameCSSkipFlags |= FRAME_CS_SKIP_HH1; }
+	else if(fill < FRAME_CS_SKIP_EXIT_FILL)
+	{ frameCSSkipFlags = 0x0000; }
+}
+
+// Called at each file boundary to update the SSD write model from the file just completed.
+void frameUpdateSSDModel(u64 tFileRead_us)
+{
+	float rateIn, rateOut, rateRaw;
+	float tCliff;
+	u64 bytesRemaining;
+
+	if((frameSSDFileBytes > 0) && (frameSSDFileBusy_us > 0) && (tFileRead_us > frameSSDFileRead_us))
+	{
+		// Input rate from frame read-in timestamps, output rate from time spent writing. While the SSD keeps up,
+		// the output rate is limited only by how fast commands can be queued, so it reads high.
+		rateIn = (float)frameSSDFileBytes * 1.0e6f / (float)(tFileRead_us - frameSSDFileRead_us);
+		rateOut = (float)frameSSDFileBytes * 1.0e6f / (float)frameSSDFileBusy_us;
+		frameSSDLatency_us = (float)frameSSDFileBusy_us / (float)nFramesPerFile;
+		frameSSDBytesSinceIdle += frameSSDFileBytes;
+
+		if(rateOut > frameSSDRatePeak)
+		{
+			frameSSDRatePeak = rateOut;
+		}
+		else if(rateOut < FRAME_SSD_CLIFF_FRACTION * frameSSDRatePeak)
+		{
+			// Past the cliff. Learn the cache size the first time through.
+			if(frameSSDCacheBytes == 0) { frameSSDCacheBytes = frameSSDBytesSinceIdle - frameSSDFileBytes; }
+
+			if(frameSSDRateSustained == 0.0f) { frameSSDRateSustained = rateOut; }
+			else { frameSSDRateSustained = 0.75f * frameSSDRateSustained + 0.25f * rateOut; }
+		}
+
+		// Raise the compression target ahead of the cliff if the sustained rate can't keep up. The raw rate is
+		// independent of the current compression ratio, so the target doesn't oscillate once applied.
+		frameCompressionTarget = FRAME_COMPRESSION_TARGET_MIN;
+		if((frameSSDCacheBytes > 0) && (frameSSDRateSustained > 0.0f))
+		{
+			if(frameSSDBytesSinceIdle < frameSSDCacheBytes)
+			{ bytesRemaining = frameSSDCacheBytes - frameSSDBytesSinceIdle; }
+			else
+			{ bytesRemaining = 0; }
+			tCliff = (float)bytesRemaining / rateIn;
+
+			rateRaw = rateIn * frameCompressionRatio;
+			if(tCliff < FRAME_SSD_HORIZON_S)
+			{
+				frameCompressionTarget = rateRaw / (FRAME_SSD_RATE_MARGIN * frameSSDRateSustained);
+				if(frameCompressionTarget < FRAME_COMPRESSION_TARGET_MIN) { frameCompressionTarget = FRAME_COMPRESSION_TARGET_MIN; }
+				if(frameCompressionTarget > FRAME_COMPRESSION_TARGET_MAX) { frameCompressionTarget = FRAME_COMPRESSION_TARGET_MAX; }
+			}
+		}
+
+		// Shed write bandwidth (and SSD power) while approaching the thermal throttle.
+		frameCompressionTarget *= frameSSDThermalBias;
+		if(frameCompressionTarget > FRAME_COMPRESSION_TARGET_MAX) { frameCompressionTarget = FRAME_COMPRESSION_TARGET_MAX; }
+	}
+
+	// Start the next file.
+	frameSSDFileBytes = 0;
+	frameSSDFileBusy_us = 0;
+	frameSSDFileRead_us = tFileRead_us;
+}
+
+// Called at each file boundary, after the SSD temperature is sampled, to predict thermal throttling.
+void frameUpdateSSDThermal(u64 tFileRead_us)
+{
+	float tempWarning, headroom, slope, tMargin, urgency;
+
+	// Temperature slope over the last file.
+	if((frameSSDTempLast_us > 0) && (tFileRead_us > frameSSDTempLast_us))
+	{
+		slope = (frameSSDTemp - frameSSDTempLast) * 1.0e6f / (float)(tFileRead_us - frameSSDTempLast_us);
+		frameSSDTempSlope = 0.5f * frameSSDTempSlope + 0.5f * slope;
+	}
+	frameSSDTempLast = frameSSDTemp;
+	frameSSDTempLast_us = tFileRead_us;
+
+	// Urgency from 0 to 1, by the predicted time to come within the margin of the warning temperature.
+	tempWarning = nvmeGetTempWarning();
+	headroom = tempWarning - frameSSDTemp;
+	if((headroom <= FRAME_SSD_THERMAL_MARGIN_C) || nvmeGetThermalWarning())
+	{ urgency = 1.0f; }
+	else if(frameSSDTempSlope > 0.0f)
+	{
+		tMargin = (headroom - FRAME_SSD_THERMAL_MARGIN_C) / frameSSDTempSlope;
+		urgency = 1.0f - tMargin / FRAME_SSD_THERMAL_HORIZON_S;
+		if(urgency < 0.0f) { urgency = 0.0f; }
+	}
+	else
+	{ urgency = 0.0f; }
+
+	if(urgency > 0.0f)
+	{
+		// Force full fan and bias rate control until the drive is clearly cooling.
+		if(!frameSSDThermalActive)
+		{
+			frameSSDThermalActive = 1;
+			frameSSDFanRestore = supervisorFanSpeed;
+			supervisorRequestFan(SUPERVISOR_FAN_HIGH);
+		}
+		frameSSDThermalBias = 1.0f + (FRAME_SSD_THERMAL_BIAS_MAX - 1.0f) * urgency;
+	}
+	else if(frameSSDThermalActive && (headroom > FRAME_SSD_THERMAL_EXIT_C) && (frameSSDTempSlope <= 0.0f))
+	{
+		frameSSDThermalActive = 0;
+		frameSSDThermalBias = 1.0f;
+		supervisorRequestFan(frameSSDFanRestore);
+	}
+}
+
+void frameUpdateTelemetry(u32 tWrite_us, u32 nFrames, XTime tNow)
+{
+	TelemetrySample_s * sample;
+	u32 iBucket, nTotal, nCumulative;
+
+	// Accumulate write latency statistics.
+	iBucket = 0;
+	while((iBucket < 31) && ((1u << iBucket) < tWrite_us)) { iBucket++; }
+	frameWriteHist[iBucket]++;
+	if(tWrite_us > frameWriteMax_us) { frameWriteMax_us = tWrite_us; }
+	nFramesTelemetry += nFrames;
+
+	if(((tNow - tTelemetryLast) * US_PER_COUNT) < FRAME_TELEMETRY_PERIOD_US) { return; }
+	tTelemetryLast = tNow;
+
+	sample = &tmBuffer[nTelemetrySamples % FRAME_TELEMETRY_BUFFER_SIZE];
+	memset(sample, 0, sizeof(TelemetrySample_s));
+	sample->tSample_us = tNow * US_PER_COUNT;
+	sample->nFrameOut = nFramesOut;
+	sample->nFrameBacklog = nFramesQueued - nFramesOut;
+	sample->nFramesWritten = nFramesTelemetry;
+
+	// Percentiles from the latency histogram.
+	nTotal = 0;
+	for(int i = 0; i < 32; i++) { nTotal += frameWriteHist[i]; }
+	nCumulative = 0;
+	for(int i = 0; i < 32; i++)
+	{
+		nCumulative += frameWriteHist[i];
+		if((sample->tWriteP50_us == 0) && (2 * nCumulative >= nTotal)) { sample->tWriteP50_us = (1u << i); }
+		if((sample->tWriteP99_us == 0) && (100 * nCumulative >= 99 * nTotal)) { sample->tWriteP99_us = (1u << i); }
+	}
+	sample->tWriteMax_us = frameWriteMax_us;
+
+	sample->compressionRatio = frameCompressionRatio;
+	sample->compressionProfile = frameCompressionProfile;
+	sample->wQueueMax = (u8) wQueueMax;
+	sample->lprQueueMax = (u8) lprQueueMax;
+	sample->hprQueueMax = (u8) hprQueueMax;
+	sample->tempPS = frameTempPS;
+	sample->tempPL = frameTempPL;
+	sample->tempCMV = frameTempCMV;
+	sample->tempSSD = frameTempSSD;
+	sample->csSkipFlags = frameCSSkipFlags;
+
+	// Start the next sample period.
+	memset(frameWriteHist, 0, sizeof(frameWriteHist));
+	frameWriteMax_us = 0;
+	nFramesTelemetry = 0;
+	mainResetDDRQueueMax();
+
+	nTelemetrySamples++;
+	if((nTelemetrySamples % FRAME_TELEMETRY_BLOCK) == 0)
+	{
+		fsWriteTelemetry((u64)(&tmBuffer[(nTelemetrySamples - FRAME_TELEMETRY_BLOCK) % FRAME_TELEMETRY_BUFFER_SIZE]),
+						 FRAME_TELEMETRY_BLOCK * sizeof(TelemetrySample_s));
+	}
+}
+
+// Write any samples not yet written in a full block.
+void frameFlushTelemetry(void)
+{
+	u32 nRemaining = nTelemetrySamples % FRAME_TELEMETRY_BLOCK;
+
+	if(nRemaining == 0) { return; }
+
+	fsWriteTelemetry((u64)(&tmBuffer[(nTelemetrySamples - nRemaining) % FRAME_TELEMETRY_BUFFER_SIZE]),
+					 nRemaining * sizeof(TelemetrySample_s));
+}
+
+// CRC-32C using the ARMv8 CRC32 instructions, 8B per instruction on the aligned body.
+__attribute__((target("+crc")))
+u32 frameCRC32C(u64 addr, u32 size)
+{
+	u32 crc = 0xFFFFFFFF;
+	const u8 * pByte = (const u8 *) addr;
+	const u64 * pDword;
+	u64 d0, d1, d2, d3, d4, d5, d6, d7;
+
+	// Unaligned head.
+	while((size > 0) && ((u64)pByte & 0x7))
+	{
+		crc = __crc32cb(crc, *pByte++);
+		size--;
+	}
+
+	// Aligned body, 64B at a time. Codestreams are non-cacheable, so each load is a full DDR4 round trip. Issuing
+	// all eight loads before the CRC uses any of them lets those round trips overlap.
+	pDword = (const u64 *) pByte;
+	while(size >= 64)
+	{
+		d0 = pDword[0]; d1 = pDword[1]; d2 = pDword[2]; d3 = pDword[3];
+		d4 = pDword[4]; d5 = pDword[5]; d6 = pDword[6]; d7 = pDword[7];
+		crc = __crc32cd(crc, d0); crc = __crc32cd(crc, d1); crc = __crc32cd(crc, d2); crc = __crc32cd(crc, d3);
+		crc = __crc32cd(crc, d4); crc = __crc32cd(crc, d5); crc = __crc32cd(crc, d6); crc = __crc32cd(crc, d7);
+		pDword += 8;
+		size -= 64;
+	}
+
+	while(size >= 8)
+	{
+		crc = __crc32cd(crc, *pDword++);
+		size -= 8;
+	}
+
+	// Tail.
+	pByte = (const u8 *) pDword;
+	while(size > 0)
+	{
+		crc = __crc32cb(crc, *pByte++);
+		size--;
+	}
 
-	// XGpioPs_WritePin(&Gpio, GPIO2_PIN, 0);		// Mark frame recorder exit.
+	return ~crc;
 }
 
-void frameUpdateCompression(const u32 * csSizeBuffer)
+OCM_TEXT void frameUpdateCompression(const u32 * csSizeBuffer)
 {
 	float wFrame, hFrame;
 	float szRaw, szCompressed;
-	static u16 nFramesOvercompressed = 0;
-	static u16 nFramesUndercompressed = 0;
+	OCM_DATA static u16 nFramesOvercompressed = 0;
+	OCM_DATA static u16 nFramesUndercompressed = 0;
 
 	wFrame = cState.cSetting[CSETTING_WIDTH]->valArray[cState.cSetting[CSETTING_WIDTH]->val].fVal;
 	hFrame = cState.cSetting[CSETTING_HEIGHT]->valArray[cState.cSetting[CSETTING_HEIGHT]->val].fVal;
@@ -328,9 +1076,10 @@ void frameUpdateCompression(const u32 * csSizeBuffer)
 	}
 
 	// Heuristic for adjusting qMultProfile to achieve target 5:1 to 6:1 compression.
-	if(frameCompressionRatio > 6.0f) { nFramesOvercompressed++; }
+	// The target is raised by the SSD write model ahead of a sustained-write cliff.
+	if(frameCompressionRatio > (frameCompressionTarget + 1.0f)) { nFramesOvercompressed++; }
 	else { nFramesOvercompressed = 0.0f; };
-	if(frameCompressionRatio < 5.0f) { nFramesUndercompressed++; }
+	if(frameCompressionRatio < frameCompressionTarget) { nFramesUndercompressed++; }
 	else { nFramesUndercompressed = 0.0f; }
 
 	if((nFramesOvercompressed > 32) && (frameCompressionProfile < (ENCODER_NUM_QMULT_PROFILES - 1)))
@@ -367,6 +1116,7 @@ void frameUpdateTemps(void)
 	frameTempCMV = (s8) fTemp;
 
 	fTemp = nvmeGetTemp();
+	frameSSDTemp = fTemp;
 	if(fTemp < -128.0f) { fTemp = -128.0f; }
 	else if(fTemp > 127.0f) { fTemp = 127.0f; }
 	frameTempSSD = (s8) fTemp;
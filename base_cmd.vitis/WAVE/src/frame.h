@@ -30,13 +30,22 @@ THE SOFTWARE.
 #include "main.h"
 #include "hdmi_lut1d.h"
 #include "cmv12000.h"
+#include "imu.h"
 
 // Public Pre-Processor Definitions ------------------------------------------------------------------------------------
 
+// Software-generated interrupt for the deferred FOT bottom half.
+#define FRAME_FOT_SGI				1
+
 // Recording States
 #define FRAME_REC_STATE_IDLE 		0x00
 #define FRAME_REC_STATE_START 		0x01
 #define FRAME_REC_STATE_CONTINUE 	0x02
+#define FRAME_REC_STATE_FINALIZE 	0x03
+
+// Codestream Skip Flags
+#define FRAME_CS_SKIP_HH1			0xF000	// Streams 12-15
+#define FRAME_CS_SKIP_HL1_LH1		0x0FF0	// Streams 4-11
 
 // Public Type Definitions ---------------------------------------------------------------------------------------------
 
@@ -60,7 +69,10 @@ typedef struct __attribute__((packed))
 	float hdrTExp2;				// Multi-slope HDR kneepoint 2 time.
 	float hdrKp2;				// Multi-slope HDR kneepoint 2 level.
 	float hdrKp2Window;			// Multi-slope HDR kneepoint 2 level window.
-	u8 reserved1[124];			// Reserved.
+	float imuSampleRate;		// IMU sample rate in [Hz].
+	float imuGyroRange;			// IMU angular rate at full scale in [deg/s].
+	float imuAccelRange;		// IMU acceleration at full scale in [g].
+	u8 reserved1[112];			// Reserved.
 	CMV_Settings_s cmvSettings; // CMV12000 image sensor settings registers.
 	u8 reserved2[202];			// Reserved.
 } ClipHeader_s;
@@ -79,12 +91,16 @@ typedef struct __attribute__((packed))
 	// Frame Information [8B]
 	u16 wFrame;					// Width
 	u16 hFrame;					// Height
-	u8  reserved0[4];			// Reserved.
+	u16 csSkipFlags;			// Codestreams not written (DDR overload). Decode these subbands as zero.
+	u8 nFramesGrouped;			// Frames written as a group: all headers, then each codestream for all frames.
+	u8 iFrameGrouped;			// Index of this frame within its group.
 
 	// Quantizer Settings [16B]
 	u32 q_mult_HH1_HL1_LH1;		// Stage 1 quantizer settings.
 	u32 q_mult_HH2_HL2_LH2;		// Stage 2 quantizer settings.
-	u8 reserved1[8];			// Reserved.
+	u8 nWaveletStages;			// Wavelet decomposition levels. Codestream 0 holds LL of the last stage.
+	u8 nFramesLost;				// Following frames that got no header (FOT overrun). Their data is in these codestreams.
+	u8 reserved1[6];			// Reserved.
 
 	// Codestream Address and Size [128B]
 	u32 csAddr[16];				// Codestream addresses in [B].
@@ -99,23 +115,61 @@ typedef struct __attribute__((packed))
 	s8 tempCMV;					// Image sensor temperature in [C].
 	s8 tempSSD;					// SSD temperature in [C].
 
-	// Padding [284B];
-	u8 reserved2[284];			// Reserved.
+	// Codestream Integrity [64B]
+	u32 csCRC32C[16];			// Codestream CRC-32C (Castagnoli), initial value and final XOR 0xFFFFFFFF.
+
+	// IMU Motion Data [204B]
+	IMUFrameData_s imu;			// Gyro and accelerometer samples read from the IMU FIFO at the start of this frame.
+
+	// Padding [16B];
+	u8 reserved2[16];			// Reserved.
 } FrameHeader_s;
 
+// 64B Telemetry Sample Structure, written to the clip's .kwt file about once per second while recording.
+typedef struct __attribute__((packed))
+{
+	u64 tSample_us;				// Sample timestamp in [us].
+	u32 nFrameOut;				// Next frame to be written.
+	u32 nFrameBacklog;			// Frame recording backlog.
+	u32 nFramesWritten;			// Frames written since the last sample.
+	u32 tWriteP50_us;			// Frame write latency, 50th percentile (power-of-two bucket) in [us].
+	u32 tWriteP99_us;			// Frame write latency, 99th percentile (power-of-two bucket) in [us].
+	u32 tWriteMax_us;			// Frame write latency, maximum in [us].
+	float compressionRatio;		// Measured compression ratio.
+	u8 compressionProfile;		// Quantizer profile.
+	u8 wQueueMax;				// DDR controller write queue high-water mark since the last sample.
+	u8 lprQueueMax;				// DDR controller low priority read queue high-water mark since the last sample.
+	u8 hprQueueMax;				// DDR controller high priority read queue high-water mark since the last sample.
+	s8 tempPS;					// CPU Processing System temperature in [C].
+	s8 tempPL;					// CPU Programmable Logic temperature in [C].
+	s8 tempCMV;					// Image sensor temperature in [C].
+	s8 tempSSD;					// SSD temperature in [C].
+	u16 csSkipFlags;			// Codestream skip flags in effect.
+	u8 reserved[18];			// Reserved.
+} TelemetrySample_s;
+
 // Public Function Prototypes ------------------------------------------------------------------------------------------
 
 void frameInit(void);
 void frameApplyCameraState(void);
 void frameCreateClip(void);
 void frameAddToClip(void);
+u8 frameRecordPending(void);
 void frameCloseClip(void);
+u32 frameGetBacklog(void);
 int frameLastCapturedIndex(void);
 FrameHeader_s * frameGetHeader(u32 iFrame);
+u32 frameCRC32C(u64 addr, u32 size);
 
 // Externed Public Global Variables ------------------------------------------------------------------------------------
 
 extern u8 frameCompressionProfile;
 extern float frameCompressionRatio;
+extern float frameCompressionTarget;
+extern u8 frameRecState;
+extern u16 frameCSSkipFlags;
+extern u64 frameSSDBytesSinceIdle;
+extern u64 frameSSDCacheBytes;
+extern float frameSSDRateSustained;
 
 #endif
@@ -27,16 +27,44 @@ THE SOFTWARE.
 #include "fs.h"
 #include "ff.h"
 #include "xrtcpsu.h"
+#include "memory_map.h"
+#include "log.h"
+#include <string.h>
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
 
 #define RTC_DEVICE_ID              XPAR_XRTCPSU_0_DEVICE_ID
 
+// Periodic commit of the open file's size and FAT state, bounding data lost to a power cut.
+#define FS_SYNC_INTERVAL_BYTES		0x04000000		// 64MiB
+#define FS_SYNC_INTERVAL_US			2000000			// 2s
+#define FS_SYNC_FORCE_BYTES			0x08000000		// 128MiB: Commit even without frame slack.
+#define FS_SYNC_FORCE_US			10000000		// 10s: Commit even without frame slack.
+
+// Write benchmark after a format or on request, streamed from codestream RAM like a recording. The result is kept
+// on the SSD so mounting doesn't have to repeat it.
+#define FS_BENCHMARK_SRC			MEM_MAP_CS_BASE
+#define FS_BENCHMARK_BYTES			0x10000000		// 256MiB
+#define FS_BENCHMARK_CHUNK			0x1000000		// 16MiB
+#define FS_BENCHMARK_PATH			"/bench.bin"
+#define FS_BENCHMARK_VERSION		1
+
 // Private Type Definitions --------------------------------------------------------------------------------------------
 
+typedef struct
+{
+	char strMagic[4];		// "BNCH"
+	u32 version;
+	float writeRate;		// [B/s]
+} FsBenchmark_s;
+
 // Private Function Prototypes -----------------------------------------------------------------------------------------
 
 void fsUpdateFreeSizeGB(void);
+u8 fsClipIsEmpty(int n);
+void fsSyncFile(void);
+void fsLoadBenchmark(void);
+void fsCloseTelemetry(void);
 
 // Public Global Variables ---------------------------------------------------------------------------------------------
 
@@ -49,10 +77,32 @@ int nClip = -1;
 FATFS fs;
 FIL fil;
 FIL filClipInfo;
+FIL filVerify;
+FIL filTelemetry;
+FIL filSmall;
+
+// Clip directory and clip info file created ahead of recording.
+int nClipStaged = -1;
+u8 fsClipInfoOpen = 0;
+
+// Read-only file used by the clip verifier.
+u8 fsVerifyOpen = 0;
+
+// Per-clip telemetry file.
+u8 fsTelemetryOpen = 0;
 
 int nFile = 0;
 u32 fsFreeGB = 0;
 u32 fsSizeGB = 0;
+float fsWriteRate = 0.0f;		// Benchmarked SSD write rate in [B/s], zero if unknown.
+
+// Sync state for the open file and per-clip sync statistics.
+u64 fsBytesSinceSync = 0;
+XTime tLastSync = 0;
+u32 fsSyncCount = 0;
+u32 fsSyncCostMax_us = 0;
+u64 fsSyncBytesMax = 0;
+u32 fsSyncIntervalMax_us = 0;
 
 // Interrupt Handlers --------------------------------------------------------------------------------------------------
 
@@ -71,10 +121,15 @@ void fsInit(void)
 	*/
 
 	res = f_mount(&fs, "", 0);
-	if(res) { xil_printf("SSD mount failed.\r\n"); }
-	else { xil_printf("SSD mount successful.\r\n"); }
+	if(res) { LOG_ERROR("SSD mount failed.\r\n"); }
+	else { LOG_INFO("SSD mount successful.\r\n"); }
 
 	nClip = fsGetNextClip();
+
+	// Reuse the last clip if it was staged but never recorded.
+	if(fsClipIsEmpty(nClip - 1)) { nClip--; }
+
+	fsLoadBenchmark();
 }
 
 void fsFormat(void)
@@ -83,6 +138,12 @@ void fsFormat(void)
 	MKFS_PARM opt;
 	BYTE work[FF_MAX_SS];
 
+	// Any staged clip or file being verified is lost with the old file system.
+	nClipStaged = -1;
+	fsClipInfoOpen = 0;
+	fsVerifyOpen = 0;
+	fsTelemetryOpen = 0;
+
 	f_mount(0, "", 0);
 
 	opt.fmt = FM_FAT32;
@@ -91,14 +152,16 @@ void fsFormat(void)
 	opt.n_fat = 1;
 	opt.n_root = 512;
 	res = f_mkfs("", &opt, work, sizeof work);
-	if(res) { xil_printf("SSD format failed.\r\n"); }
-	else { xil_printf("SSD format successful.\r\n"); }
+	if(res) { LOG_ERROR("SSD format failed.\r\n"); }
+	else { LOG_INFO("SSD format successful.\r\n"); }
 
 	res = f_mount(&fs, "", 0);
-	if(res) { xil_printf("SSD mount failed.\r\n"); }
-	else { xil_printf("SSD mount successful.\r\n"); }
+	if(res) { LOG_ERROR("SSD mount failed.\r\n"); }
+	else { LOG_INFO("SSD mount successful.\r\n"); }
 
-	fsGetNextClip();
+	nClip = fsGetNextClip();
+
+	fsBenchmark();
 }
 
 u32 fsGetNextClip(void)
@@ -126,21 +189,51 @@ u32 fsGetNextClip(void)
 	return nClipNext;
 }
 
-void fsCreateClip(void)
+void fsStageClip(void)
 {
 	FRESULT res;
 	char strWorking[32];
 
+	// One attempt per clip number.
+	if(nClipStaged == nClip) { return; }
+	nClipStaged = nClip;
+	fsClipInfoOpen = 0;
+
 	if((nClip < 0) || (nClip > 9999)) { return; }
 
+	// Only an existing clip directory that was staged but never recorded can be reused.
 	sprintf(strWorking, "c%04d", nClip);
 	res = f_mkdir(strWorking);
-	if(res) { xil_printf("Warning: New clip creation failed.\r\n"); }
-	else { xil_printf("Created new clip.\r\n"); }
+	if((res == FR_EXIST) && fsClipIsEmpty(nClip)) { res = FR_OK; }
+	if(res) { LOG_WARNING("Warning: New clip creation failed.\r\n"); return; }
 
-	// Create and open the clip info file.
+	// Create and open the clip info file. It stays empty until the clip is started.
 	sprintf(strWorking, "/c%04d/c%04d.kwi", nClip, nClip);
-	res = f_open(&filClipInfo, strWorking, FA_CREATE_NEW | FA_WRITE);
+	res = f_open(&filClipInfo, strWorking, FA_CREATE_ALWAYS | FA_WRITE);
+	if(res == FR_OK) { fsClipInfoOpen = 1; }
+}
+
+void fsCreateClip(void)
+{
+	char strWorking[32];
+
+	// Normally already staged in standby. Retry here if staging failed.
+	if(!fsClipInfoOpen) { nClipStaged = -1; }
+	fsStageClip();
+
+	if(fsClipInfoOpen) { LOG_INFO("Created new clip.\r\n"); }
+
+	// Telemetry file, written alongside the frame files.
+	if(fsClipInfoOpen)
+	{
+		sprintf(strWorking, "/c%04d/c%04d.kwt", nClip, nClip);
+		if(f_open(&filTelemetry, strWorking, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK) { fsTelemetryOpen = 1; }
+	}
+
+	fsSyncCount = 0;
+	fsSyncCostMax_us = 0;
+	fsSyncBytesMax = 0;
+	fsSyncIntervalMax_us = 0;
 }
 
 void fsWriteClipInfo(u64 srcAddress, u32 size)
@@ -155,6 +248,7 @@ void fsWriteClipInfo(u64 srcAddress, u32 size)
 void fsCloseClipInfo(void)
 {
 	f_close(&filClipInfo);
+	fsClipInfoOpen = 0;
 }
 
 void fsCreateFile(void)
@@ -173,6 +267,9 @@ void fsCreateFile(void)
 	res = f_open(&fil, strWorking, FA_CREATE_NEW | FA_WRITE);
 	res = f_expand(&fil, 0x1000000, 1);		// Reserve 16MiB.
 
+	fsBytesSinceSync = 0;
+	XTime_GetTime(&tLastSync);
+
 	nFile++;
 
 	(void) res;
@@ -184,25 +281,126 @@ void fsWriteFile(u64 srcAddress, u32 size)
 	UINT bw;
 
 	res = f_write(&fil, (u8 *) srcAddress, size, &bw);
+	fsBytesSinceSync += bw;
 	(void) res;
 }
 
+// Append samples to the clip's telemetry file. Dropped if the file couldn't be opened.
+void fsWriteTelemetry(u64 srcAddress, u32 size)
+{
+	FRESULT res;
+	UINT bw;
+
+	if(!fsTelemetryOpen) { return; }
+
+	res = f_write(&filTelemetry, (u8 *) srcAddress, size, &bw);
+	(void) res;
+}
+
+// Commit the open file's size and FAT state if enough data or time has accumulated. Called with inSlack
+// set when the recorder is caught up, otherwise only commits once a forced threshold is reached.
+void fsServiceSync(u8 inSlack)
+{
+	XTime tNow;
+	u32 tSinceSync_us;
+
+	if((nFile == 0) || (fsBytesSinceSync == 0)) { return; }
+
+	XTime_GetTime(&tNow);
+	tSinceSync_us = (tNow - tLastSync) * US_PER_COUNT;
+
+	if(inSlack)
+	{
+		if((fsBytesSinceSync >= FS_SYNC_INTERVAL_BYTES) || (tSinceSync_us >= FS_SYNC_INTERVAL_US))
+		{ fsSyncFile(); }
+	}
+	else if((fsBytesSinceSync >= FS_SYNC_FORCE_BYTES) || (tSinceSync_us >= FS_SYNC_FORCE_US))
+	{
+		fsSyncFile();
+	}
+}
+
 void fsCloseClip(void)
 {
 	// Truncate and close any open files first.
 	f_truncate(&fil);
 	f_close(&fil);
+	fsCloseTelemetry();
+
+	// Report sync cost and the worst-case exposure to a power cut for this clip.
+	LOG_INFO("Clip synced %d times. Max cost: %d us. Max window: %d MiB, %d ms.\r\n",
+			   fsSyncCount, fsSyncCostMax_us, (u32)(fsSyncBytesMax >> 20), fsSyncIntervalMax_us / 1000);
 
 	nClip = fsGetNextClip();
 	nFile = 0;
 }
 
+u8 fsOpenVerifyFile(int n, int iFile)
+{
+	FRESULT res;
+	char strWorking[32];
+
+	fsCloseVerifyFile();
+
+	sprintf(strWorking, "/c%04d/f%06d.kwv", n, iFile);
+	res = f_open(&filVerify, strWorking, FA_READ);
+	if(res == FR_OK) { fsVerifyOpen = 1; }
+
+	return fsVerifyOpen;
+}
+
+u32 fsReadVerifyFile(u64 destAddress, u32 size)
+{
+	FRESULT res;
+	UINT br = 0;
+
+	if(!fsVerifyOpen) { return 0; }
+
+	res = f_read(&filVerify, (u8 *) destAddress, size, &br);
+	if(res) { return 0; }
+
+	return br;
+}
+
+void fsCloseVerifyFile(void)
+{
+	if(fsVerifyOpen) { f_close(&filVerify); }
+	fsVerifyOpen = 0;
+}
+
+u32 fsLoadFile(const char * strPath, void * dest, u32 size)
+{
+	UINT br = 0;
+
+	if(f_open(&filSmall, strPath, FA_OPEN_EXISTING | FA_READ) != FR_OK) { return 0; }
+	if(f_read(&filSmall, dest, size, &br) != FR_OK) { br = 0; }
+	f_close(&filSmall);
+
+	return br;
+}
+
+u8 fsSaveFile(const char * strPath, const void * src, u32 size)
+{
+	FRESULT res;
+	UINT bw = 0;
+
+	res = f_open(&filSmall, strPath, FA_CREATE_ALWAYS | FA_WRITE);
+	if(res != FR_OK) { return 0; }
+	res = f_write(&filSmall, src, size, &bw);
+	if(f_close(&filSmall) != FR_OK) { res = FR_DISK_ERR; }
+
+	return (res == FR_OK) && (bw == size);
+}
+
 void fsDeinit(void)
 {
 	FRESULT res;
 
 	res = f_truncate(&fil);
 	res = f_close(&fil);
+	if(fsClipInfoOpen) { fsCloseClipInfo(); }
+	fsCloseVerifyFile();
+	fsCloseTelemetry();
 	res = f_mount(0, "", 0);
 	(void) res;
 }
@@ -221,3 +419,105 @@ void fsUpdateFreeSizeGB(void)
 	if(res == FR_OK) { fsFreeGB = nFreeClusters / 15259; }
 	else { fsFreeGB = 0; }
 }
+
+// Check for a clip directory with an empty clip info file, left behind by staging.
+u8 fsClipIsEmpty(int n)
+{
+	FILINFO fInfo;
+	char strWorking[32];
+
+	if((n < 0) || (n > 9999)) { return 0; }
+
+	sprintf(strWorking, "/c%04d/c%04d.kwi", n, n);
+	if(f_stat(strWorking, &fInfo) != FR_OK) { return 0; }
+
+	return (fInfo.fsize == 0);
+}
+
+// Restore the write rate saved by the last benchmark. Unknown if it's missing or corrupt.
+void fsLoadBenchmark(void)
+{
+	FsBenchmark_s bench;
+	u32 nBytes;
+
+	fsWriteRate = 0.0f;
+
+	nBytes = fsLoadFile(FS_BENCHMARK_PATH, &bench, sizeof(FsBenchmark_s));
+	if((nBytes != sizeof(FsBenchmark_s))
+	|| (memcmp(bench.strMagic, "BNCH", 4) != 0)
+	|| (bench.version != FS_BENCHMARK_VERSION)
+	|| !(bench.writeRate > 0.0f) || !(bench.writeRate < 1.0e11f))
+	{ return; }
+
+	fsWriteRate = bench.writeRate;
+	LOG_INFO("SSD write rate: %d MB/s (saved).\r\n", (u32)(fsWriteRate / 1.0e6f));
+}
+
+void fsCloseTelemetry(void)
+{
+	if(fsTelemetryOpen) { f_close(&filTelemetry); }
+	fsTelemetryOpen = 0;
+}
+
+void fsBenchmark(void)
+{
+	FRESULT res;
+	FIL filBench;
+	UINT bw;
+	XTime tStart, tEnd;
+	u32 nBytes = 0;
+	FsBenchmark_s bench;
+
+	fsWriteRate = 0.0f;
+
+	res = f_open(&filBench, "/bench.tmp", FA_CREATE_ALWAYS | FA_WRITE);
+	if(res) { return; }
+	f_expand(&filBench, FS_BENCHMARK_BYTES, 1);
+
+	XTime_GetTime(&tStart);
+	for(u32 offset = 0; (offset < FS_BENCHMARK_BYTES) && (res == FR_OK); offset += FS_BENCHMARK_CHUNK)
+	{
+		res = f_write(&filBench, (u8 *)((u64)(FS_BENCHMARK_SRC + offset)), FS_BENCHMARK_CHUNK, &bw);
+		nBytes += bw;
+	}
+	f_sync(&filBench);
+	XTime_GetTime(&tEnd);
+
+	f_close(&filBench);
+	f_unlink("/bench.tmp");
+
+	if((res == FR_OK) && (tEnd > tStart))
+	{
+		fsWriteRate = (float)nBytes * (float)COUNTS_PER_SECOND / (float)(tEnd - tStart);
+		LOG_INFO("SSD write benchmark: %d MB/s.\r\n", (u32)(fsWriteRate / 1.0e6f));
+
+		memcpy(bench.strMagic, "BNCH", 4);
+		bench.version = FS_BENCHMARK_VERSION;
+		bench.writeRate = fsWriteRate;
+		if(!fsSaveFile(FS_BENCHMARK_PATH, &bench, sizeof(FsBenchmark_s)))
+		{
+			LOG_WARNING("Warning: SSD benchmark result write failed.\r\n");
+		}
+	}
+}
+
+void fsSyncFile(void)
+{
+	XTime tStart, tEnd;
+	u32 tCost_us, tInterval_us;
+
+	XTime_GetTime(&tStart);
+	f_sync(&fil);
+	XTime_GetTime(&tEnd);
+
+	tCost_us = (tEnd - tStart) * US_PER_COUNT;
+	tInterval_us = (tEnd - tLastSync) * US_PER_COUNT;
+
+	fsSyncCount++;
+	if(tCost_us > fsSyncCostMax_us) { fsSyncCostMax_us = tCost_us; }
+	if(fsBytesSinceSync > fsSyncBytesMax) { fsSyncBytesMax = fsBytesSinceSync; }
+	if(tInterval_us > fsSyncIntervalMax_us) { fsSyncIntervalMax_us = tInterval_us; }
+
+	fsBytesSinceSync = 0;
+	tLastSync = tEnd;
+}
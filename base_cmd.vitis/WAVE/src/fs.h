@@ -37,13 +37,28 @@ THE SOFTWARE.
 
 void fsInit(void);
 void fsFormat(void);
+
+// Measure the SSD write rate into fsWriteRate and save it for the next mount. Writes and deletes a 256MiB file.
+void fsBenchmark(void);
+
 u32 fsGetNextClip(void);
+void fsStageClip(void);
 void fsCreateClip(void);
 void fsWriteClipInfo(u64 srcAddress, u32 size);
 void fsCloseClipInfo(void);
 void fsCreateFile(void);
 void fsWriteFile(u64 srcAddress, u32 size);
+void fsWriteTelemetry(u64 srcAddress, u32 size);
+void fsServiceSync(u8 inSlack);
 void fsCloseClip(void);
+u8 fsOpenVerifyFile(int n, int iFile);
+u32 fsReadVerifyFile(u64 destAddress, u32 size);
+void fsCloseVerifyFile(void);
+
+// Whole-file access for small files, such as the link training cache. Only from the core that owns the SSD: core 0
+// before storageInit(), the storage core after.
+u32 fsLoadFile(const char * strPath, void * dest, u32 size);
+u8 fsSaveFile(const char * strPath, const void * src, u32 size);
 void fsDeinit(void);
 
 // Externed Public Global Variables ------------------------------------------------------------------------------------
@@ -51,5 +66,6 @@ void fsDeinit(void);
 extern int nClip;
 extern u32 fsFreeGB;
 extern u32 fsSizeGB;
+extern float fsWriteRate;
 
 #endif
@@ -31,9 +31,11 @@ THE SOFTWARE.
 #include "hdmi_lut3d.h"
 #include "gpio.h"
 #include "frame.h"
+#include "encoder.h"
 #include "xiicps.h"
 #include "camera_state.h"
 #include "cmv12000.h"
+#include "trace.h"
 #include <math.h>
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
@@ -133,18 +135,18 @@ XIicPs hdmiIic;
 u8 hdmiIicTx[256];    /**< Buffer for Transmitting Data */
 u8 hdmiIicRx[256];    /**< Buffer for Receiving Data */
 
-s32 hdmiFrame = -1;
+OCM_DATA s32 hdmiFrame = -1;
 
 HDMI_s hdmiSync;
-u32 hdmiApplyCameraStateSyncFlag = 0;
+OCM_DATA u32 hdmiApplyCameraStateSyncFlag = 0;
 
 // Interrupt Handlers --------------------------------------------------------------------------------------------------
-void isrVSYNC(void * CallbackRef)
+OCM_TEXT void isrVSYNC(void * CallbackRef)
 {
 	FrameHeader_s fhSnapshot;
 	u32 bitDiscard[4];
 
-	XGpioPs_WritePin(&Gpio, GPIO2_PIN, 1);	// Mark ISR entry.
+	traceEvent(TRACE_VSYNC_ENTER, 0);
 
 	hdmi->control &= ~HDMI_CTRL_VSYNC_IF;	// Clear the VSYNC interrupt flag.
 
@@ -186,7 +188,7 @@ void isrVSYNC(void * CallbackRef)
 
 	mainServiceTrigger();
 
-	XGpioPs_WritePin(&Gpio, GPIO2_PIN, 0);	// Mark ISR exit.
+	traceEvent(TRACE_VSYNC_EXIT, 0);
 }
 
 // Public Function Definitions -----------------------------------------------------------------------------------------
@@ -199,10 +201,10 @@ void hdmiInit(void)
 	// Load HDMI peripheral registers with initial values.
 	hdmi->q_mult_inv_HL2_LH2 = 1024;
 	hdmi->q_mult_inv_HH2 = 2048;
-	hdmi->dc_RAM_addr_update_LL2 = 0x20000000;
-	hdmi->dc_RAM_addr_update_LH2 = 0x38000000;
-	hdmi->dc_RAM_addr_update_HL2 = 0x3E000000;
-	hdmi->dc_RAM_addr_update_HH2 = 0x44000000;
+	hdmi->dc_RAM_addr_update_LL2 = encoderGetCSBase(0);
+	hdmi->dc_RAM_addr_update_LH2 = encoderGetCSBase(1);
+	hdmi->dc_RAM_addr_update_HL2 = encoderGetCSBase(2);
+	hdmi->dc_RAM_addr_update_HH2 = encoderGetCSBase(3);
 	hdmi->bit_discard_update_LL2 = 0;
 	hdmi->bit_discard_update_LH2 = 0;
 	hdmi->bit_discard_update_HL2 = 0;
@@ -452,7 +454,7 @@ void hdmiWriteTestPattern4K(void)
 	u16 wipPixel;
 
 	// LL2
-	hdmiResetTestPatternState(0x20000000);
+	hdmiResetTestPatternState(encoderGetCSBase(0));
 	for(u16 pxDiscard = 1584; pxDiscard > 0; pxDiscard--)
 	{
 		for(u8 i4px = 0; i4px < 4; i4px++)
@@ -480,7 +482,7 @@ void hdmiWriteTestPattern4K(void)
 	}
 
 	// LH2
-	hdmiResetTestPatternState(0x38000000);
+	hdmiResetTestPatternState(encoderGetCSBase(1));
 	for(u16 pxDiscard = 1584; pxDiscard > 0; pxDiscard--)
 	{
 		hdmiPushTestPatternBits(0x3F, 8);
@@ -510,7 +512,7 @@ void hdmiWriteTestPattern4K(void)
 	}
 
 	// HL2
-	hdmiResetTestPatternState(0x3E000000);
+	hdmiResetTestPatternState(encoderGetCSBase(2));
 	for(u16 pxDiscard = 1584; pxDiscard > 0; pxDiscard--)
 	{
 		hdmiPushTestPatternBits(0x3F, 8);
@@ -540,7 +542,7 @@ void hdmiWriteTestPattern4K(void)
 	}
 
 	// HH2
-	hdmiResetTestPatternState(0x44000000);
+	hdmiResetTestPatternState(encoderGetCSBase(3));
 	for(u16 pxDiscard = 1584; pxDiscard > 0; pxDiscard--)
 	{
 		hdmiPushTestPatternBits(0x3F, 8);
@@ -576,7 +578,7 @@ void hdmiWriteTestPattern2K(void)
 	u16 wipPixel;
 
 	// LL2
-	hdmiResetTestPatternState(0x20000000);
+	hdmiResetTestPatternState(encoderGetCSBase(0));
 	for(u16 pxDiscard = 832; pxDiscard > 0; pxDiscard--)
 	{
 		for(u8 i4px = 0; i4px < 4; i4px++)
@@ -605,7 +607,7 @@ void hdmiWriteTestPattern2K(void)
 	}
 
 	// LH2
-	hdmiResetTestPatternState(0x38000000);
+	hdmiResetTestPatternState(encoderGetCSBase(1));
 	for(u16 pxDiscard = 830; pxDiscard > 0; pxDiscard--)
 	{
 		hdmiPushTestPatternBits(0x3F, 8);
@@ -635,7 +637,7 @@ void hdmiWriteTestPattern2K(void)
 	}
 
 	// HL2
-	hdmiResetTestPatternState(0x3E000000);
+	hdmiResetTestPatternState(encoderGetCSBase(2));
 	for(u16 pxDiscard = 830; pxDiscard > 0; pxDiscard--)
 	{
 		hdmiPushTestPatternBits(0x3F, 8);
@@ -665,7 +667,7 @@ void hdmiWriteTestPattern2K(void)
 	}
 
 	// HH2
-	hdmiResetTestPatternState(0x44000000);
+	hdmiResetTestPatternState(encoderGetCSBase(3));
 	for(u16 pxDiscard = 830; pxDiscard > 0; pxDiscard--)
 	{
 		hdmiPushTestPatternBits(0x3F, 8);
@@ -26,7 +26,9 @@ THE SOFTWARE.
 
 #include "main.h"
 #include "imu.h"
-#include "xspips.h"
+#include "trace.h"
+#include "log.h"
+#include <string.h>
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
 
@@ -41,6 +43,8 @@ THE SOFTWARE.
 #define BMI160_ACC_CONF 0x40         // accel configuration
 #define BMI160_GYR_RATE_X_LSB 0x0C   // gyro X axis LSB
 #define BMI160_TEMPERATURE_LSB 0x20  // chip temperature LSB
+#define BMI160_FIFO_LENGTH_0 0x22    // FIFO byte count LSB, followed by MSB and FIFO_DATA
+#define BMI160_FIFO_CONFIG_1 0x47    // FIFO frame content
 #define BMI160_INT_EN_0 0x51         // interrupt enable register
 #define BMI160_INT_OUT_CTRL 0x53     // interrupt output type register
 #define BMI160_INT_MAP_1 0x56        // interrupt mapping register
@@ -49,6 +53,20 @@ THE SOFTWARE.
 #define BMI160_RD_REG 0x80           // MSB 1 to read
 #define BMI160_ADDR_MASK 0x7F		 // Bits 6:0 are the register address
 
+#define BMI160_CHIPID_VAL 0xD1
+#define BMI160_CMD_ACC_NORMAL 0x11
+#define BMI160_CMD_GYR_NORMAL 0x15
+#define BMI160_CMD_FIFO_FLUSH 0xB0
+#define BMI160_CONF_200HZ 0x29       // Normal filter mode, 200Hz ODR (matches IMU_SAMPLE_RATE_HZ)
+#define BMI160_ACC_RANGE_8G 0x08
+#define BMI160_GYR_RANGE_1000DPS 0x01
+#define BMI160_FIFO_GYR_ACC 0xC0     // Gyro and accel, headerless
+#define BMI160_FIFO_SIZE 1024
+
+// FIFO burst: address byte, two FIFO_LENGTH bytes, then FIFO_DATA.
+#define IMU_BURST_HEADER 3
+#define IMU_BURST_MAX (IMU_BURST_HEADER + IMU_SAMPLES_PER_FRAME * sizeof(IMUSample_s))
+
 // Private Type Definitions --------------------------------------------------------------------------------------------
 
 // Private Function Prototypes -----------------------------------------------------------------------------------------
@@ -58,23 +76,128 @@ void imuRegWrite(XSpiPs * spiDevice, u8 addr, u8 val);
 
 // Public Global Variables ---------------------------------------------------------------------------------------------
 
+XSpiPs Spi1;
+
 // Private Global Variables --------------------------------------------------------------------------------------------
 
-XSpiPs Spi1;
 XSpiPs_Config *spi1Config;
 
+OCM_DATA u8 imuReady = 0;
+OCM_DATA volatile u8 imuBusy = 0;
+OCM_DATA IMUFrameData_s * imuDataActive;
+OCM_DATA u32 imuReadCount = 0;
+OCM_DATA u32 imuFIFOPending = 0;			// Samples known to be left in the FIFO after the last read.
+OCM_DATA u64 tIMUReadLast_us = 0;
+
+u8 imuTxBuffer[IMU_BURST_MAX];
+u8 imuRxBuffer[IMU_BURST_MAX];
+
 // Interrupt Handlers --------------------------------------------------------------------------------------------------
 
+// SPI1 status handler, called from XSpiPs_InterruptHandler when the FIFO burst completes.
+void isrIMU(void * CallBackRef, u32 StatusEvent, u32 ByteCount)
+{
+	u32 fifoLength, nFIFOFrames, nRead;
+
+	traceEvent(TRACE_IMU_ENTER, StatusEvent);
+
+	if(StatusEvent == XST_SPI_TRANSFER_DONE)
+	{
+		fifoLength = ((imuRxBuffer[2] & 0x07) << 8) | imuRxBuffer[1];
+		nFIFOFrames = fifoLength / sizeof(IMUSample_s);
+		nRead = imuReadCount;
+		if(nRead > nFIFOFrames) { nRead = nFIFOFrames; }
+
+		memcpy(imuDataActive->sample, &imuRxBuffer[IMU_BURST_HEADER], nRead * sizeof(IMUSample_s));
+		imuDataActive->nSamples = nRead;
+		imuDataActive->nFIFOFrames = nFIFOFrames;
+		if(fifoLength > (BMI160_FIFO_SIZE - sizeof(IMUSample_s)))
+		{ imuDataActive->flags |= IMU_FLAG_OVERFLOW; }
+
+		imuFIFOPending = nFIFOFrames - nRead;
+	}
+
+	imuBusy = 0;
+
+	traceEvent(TRACE_IMU_EXIT, 0);
+}
+
 // Public Function Definitions -----------------------------------------------------------------------------------------
 
 void imuInit(void)
 {
-	// Set up SPI0 for CMV12000 serial control.
+	XTime tNow;
+
+	// Set up SPI1 for BMI160 serial control.
 	spi1Config = XSpiPs_LookupConfig(SPI1_DEVICE_ID);
 	XSpiPs_CfgInitialize(&Spi1, spi1Config, spi1Config->BaseAddress);
 	XSpiPs_SetOptions(&Spi1, XSPIPS_MASTER_OPTION | XSPIPS_FORCE_SSELECT_OPTION);
 	XSpiPs_SetClkPrescaler(&Spi1, XSPIPS_CLK_PRESCALE_64);
 	XSpiPs_SetSlaveSelect(&Spi1, 0x0F);
+
+	// A dummy read switches the BMI160 from I2C to SPI.
+	imuRegRead(&Spi1, 0x7F);
+	if(imuRegRead(&Spi1, BMI160_CHIPID) != BMI160_CHIPID_VAL)
+	{
+		LOG_WARNING("IMU not found.\r\n");
+		return;
+	}
+
+	// Power up the accelerometer and gyro, then configure them to fill the FIFO.
+	imuRegWrite(&Spi1, BMI160_CMD, BMI160_CMD_ACC_NORMAL);
+	usleep(5000);
+	imuRegWrite(&Spi1, BMI160_CMD, BMI160_CMD_GYR_NORMAL);
+	usleep(81000);
+	imuRegWrite(&Spi1, BMI160_ACC_CONF, BMI160_CONF_200HZ);
+	imuRegWrite(&Spi1, BMI160_ACC_RANGE, BMI160_ACC_RANGE_8G);
+	imuRegWrite(&Spi1, BMI160_GYR_CONF, BMI160_CONF_200HZ);
+	imuRegWrite(&Spi1, BMI160_GYR_RANGE, BMI160_GYR_RANGE_1000DPS);
+	imuRegWrite(&Spi1, BMI160_FIFO_CONFIG_1, BMI160_FIFO_GYR_ACC);
+	imuRegWrite(&Spi1, BMI160_CMD, BMI160_CMD_FIFO_FLUSH);
+
+	// FIFO bursts are interrupt-driven from here on.
+	memset(imuTxBuffer, 0, IMU_BURST_MAX);
+	imuTxBuffer[0] = BMI160_RD_REG | BMI160_FIFO_LENGTH_0;
+	XSpiPs_SetStatusHandler(&Spi1, &Spi1, isrIMU);
+
+	XTime_GetTime(&tNow);
+	tIMUReadLast_us = tNow * US_PER_COUNT;
+	imuFIFOPending = 0;
+	imuReady = 1;
+}
+
+// Start a FIFO burst read into the IMU data of a frame header. Called from isrFOT, once per frame. The transfer
+// completes in isrIMU, so this only costs the time to load the SPI TX FIFO.
+OCM_TEXT void imuServiceFOT(IMUFrameData_s * imuData, u64 tRead_us)
+{
+	u32 nArrived, nRead;
+
+	if(!imuReady) { return; }
+	if(imuBusy)
+	{
+		imuData->flags |= IMU_FLAG_SKIPPED;
+		return;
+	}
+
+	// Read only samples known to be in the FIFO, so the burst never over-reads into a sample arriving mid-transfer.
+	// One new sample is held back since their phase is unknown. Anything left is read on the next frame.
+	nArrived = (u32)((float)(tRead_us - tIMUReadLast_us) * IMU_SAMPLE_RATE_HZ * 1.0e-6f);
+	if(nArrived > 0) { nArrived--; }
+	nRead = imuFIFOPending + nArrived;
+	if(nRead > IMU_SAMPLES_PER_FRAME) { nRead = IMU_SAMPLES_PER_FRAME; }
+
+	imuData->tRead_us = tRead_us;
+	imuDataActive = imuData;
+	imuReadCount = nRead;
+	tIMUReadLast_us = tRead_us;
+
+	imuBusy = 1;
+	XSpiPs_SetSlaveSelect(&Spi1, 0x00);
+	if(XSpiPs_Transfer(&Spi1, imuTxBuffer, imuRxBuffer, IMU_BURST_HEADER + nRead * sizeof(IMUSample_s)) != XST_SUCCESS)
+	{
+		imuData->flags |= IMU_FLAG_SKIPPED;
+		imuBusy = 0;
+	}
 }
 
 // Private Function Definitions ----------------------------------------------------------------------------------------
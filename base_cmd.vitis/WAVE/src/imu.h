@@ -27,14 +27,49 @@ THE SOFTWARE.
 
 // Include Headers -----------------------------------------------------------------------------------------------------
 
+#include "main.h"
+#include "xspips.h"
+
 // Public Pre-Processor Definitions ------------------------------------------------------------------------------------
 
+// BMI160 FIFO configuration, recorded in the clip header for scaling samples.
+#define IMU_SAMPLE_RATE_HZ			200.0f
+#define IMU_GYRO_RANGE_DPS			1000.0f		// Full scale is +/-32768.
+#define IMU_ACCEL_RANGE_G			8.0f		// Full scale is +/-32768.
+
+#define IMU_SAMPLES_PER_FRAME		16
+
+// IMU Frame Data Flags
+#define IMU_FLAG_SKIPPED			0x01		// Previous FIFO read still in progress. No samples read this frame.
+#define IMU_FLAG_OVERFLOW			0x02		// FIFO was full. Older samples were lost.
+
 // Public Type Definitions ---------------------------------------------------------------------------------------------
 
+// 12B BMI160 headerless FIFO frame, gyro then accelerometer.
+typedef struct __attribute__((packed))
+{
+	s16 gyro[3];				// Angular rate X, Y, Z.
+	s16 accel[3];				// Acceleration X, Y, Z.
+} IMUSample_s;
+
+// 204B IMU data attached to each frame header.
+typedef struct __attribute__((packed))
+{
+	u64 tRead_us;				// FIFO read start timestamp in [us].
+	u8 nSamples;				// Samples read, oldest first.
+	u8 nFIFOFrames;				// Samples in the FIFO at read start. Sample i is (nFIFOFrames - 1 - i) periods old.
+	u8 flags;					// IMU Frame Data Flags.
+	u8 reserved;				// Reserved.
+	IMUSample_s sample[IMU_SAMPLES_PER_FRAME];
+} IMUFrameData_s;
+
 // Public Function Prototypes ------------------------------------------------------------------------------------------
 
 void imuInit(void);
+void imuServiceFOT(IMUFrameData_s * imuData, u64 tRead_us);
 
 // Externed Public Global Variables ------------------------------------------------------------------------------------
 
+extern XSpiPs Spi1;
+
 #endif
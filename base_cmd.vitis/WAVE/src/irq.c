@@ -0,0 +1,287 @@
+/*
+WAVE Interrupt Dispatcher
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "irq.h"
+#include "trace.h"
+#include "xil_exception.h"
+#include <string.h>
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define IRQ_SOURCES_MAX			16
+#define IRQ_NEST_MAX			8			// More than the number of distinct priority levels in use.
+#define IRQ_BINARY_POINT		0x02		// Group priority [7:3], subpriority [2:0].
+#define IRQ_CYCLES_PER_US		(XPAR_CPU_CORTEXA53_0_CPU_CLK_FREQ_HZ / 1000000)
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+// Per-IRQ accounting, in A53 cycles.
+typedef struct
+{
+	const char * strName;
+	u32 id;
+	u8 priority;
+	u32 nCalls;
+	u32 nPreemptions;			// Times this IRQ preempted another handler.
+	u64 tExclusiveSum;			// Handler time, not counting handlers nested in it.
+	u64 tExclusiveMax;
+	u64 tInclusiveMax;			// Handler time, counting handlers nested in it.
+} IrqSource_s;
+
+// FP/SIMD register file of a preempted handler.
+typedef struct __attribute__((aligned(16)))
+{
+	u64 q[64];
+	u64 fpcr;
+	u64 fpsr;
+} IrqFPContext_s;
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+void irqDispatch(void * CallbackRef);
+void irqSaveFP(IrqFPContext_s * context);
+void irqRestoreFP(IrqFPContext_s * context);
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+XScuGic * irqGic;
+
+OCM_DATA IrqSource_s irqSource[IRQ_SOURCES_MAX];
+OCM_DATA u32 nIrqSources = 0;
+OCM_DATA IrqSource_s * irqSourceByID[XSCUGIC_MAX_NUM_INTR_INPUTS];
+
+// Nesting state.
+OCM_DATA u32 irqDepth = 0;
+OCM_DATA u32 irqDepthMax = 0;
+OCM_DATA u64 irqChildCycles[IRQ_NEST_MAX];	// Time spent in handlers nested at each depth.
+OCM_DATA u64 irqMaskedMax = 0;				// Longest time the dispatcher itself runs with IRQs masked.
+OCM_DATA u32 nIrqSpurious = 0;
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+/*
+IRQ Exception Dispatcher
+- Replaces XScuGic_InterruptHandler() as the handler for the IRQ exception.
+- Acknowledging an interrupt raises the GIC running priority to its priority, so only strictly higher-priority
+  interrupts are signaled while its handler runs with IRQs unmasked. End of interrupt drops it back.
+- Exception return state and FP/SIMD registers of the preempted context are saved around the handler, since a
+  nested IRQ exception overwrites them and the BSP's exception entry does not expect to nest.
+*/
+OCM_TEXT void irqDispatch(void * CallbackRef)
+{
+	XScuGic * gic = (XScuGic *) CallbackRef;
+	XScuGic_VectorTableEntry * entry;
+	IrqSource_s * source;
+	IrqFPContext_s fpContext;
+	u32 iar, id, depth;
+	u64 elr, spsr;
+	u64 tEnter, tStart, tEnd, tExit, tInclusive, tExclusive;
+
+	tEnter = traceGetCycles();
+
+	iar = XScuGic_ReadReg(gic->Config->CpuBaseAddress, XSCUGIC_INT_ACK_OFFSET);
+	id = iar & XSCUGIC_ACK_INTID_MASK;
+	if(id >= XSCUGIC_MAX_NUM_INTR_INPUTS)
+	{
+		// Spurious. Nothing to end.
+		nIrqSpurious++;
+		return;
+	}
+
+	depth = irqDepth++;
+	if(irqDepth > irqDepthMax) { irqDepthMax = irqDepth; }
+	if(depth < IRQ_NEST_MAX) { irqChildCycles[depth] = 0; }
+
+	asm volatile("mrs %0, elr_el3" : "=r" (elr));
+	asm volatile("mrs %0, spsr_el3" : "=r" (spsr));
+	irqSaveFP(&fpContext);
+
+	entry = &(gic->Config->HandlerTable[id]);
+	tStart = traceGetCycles();
+	asm volatile("msr daifclr, #2");
+
+	entry->Handler(entry->CallBackRef);
+
+	asm volatile("msr daifset, #2");
+	tEnd = traceGetCycles();
+
+	irqRestoreFP(&fpContext);
+	asm volatile("msr spsr_el3, %0" : : "r" (spsr));
+	asm volatile("msr elr_el3, %0" : : "r" (elr));
+
+	XScuGic_WriteReg(gic->Config->CpuBaseAddress, XSCUGIC_EOI_OFFSET, iar);
+	irqDepth--;
+
+	// Accounting.
+	tExit = traceGetCycles();
+	tInclusive = tEnd - tStart;
+	tExclusive = tInclusive - ((depth < IRQ_NEST_MAX) ? irqChildCycles[depth] : 0);
+	if((depth > 0) && (depth <= IRQ_NEST_MAX)) { irqChildCycles[depth - 1] += tExit - tEnter; }
+	if((tExit - tEnter - tInclusive) > irqMaskedMax) { irqMaskedMax = tExit - tEnter - tInclusive; }
+
+	source = irqSourceByID[id];
+	if(source == NULL) { return; }
+	source->nCalls++;
+	if(depth > 0) { source->nPreemptions++; }
+	source->tExclusiveSum += tExclusive;
+	if(tExclusive > source->tExclusiveMax) { source->tExclusiveMax = tExclusive; }
+	if(tInclusive > source->tInclusiveMax) { source->tInclusiveMax = tInclusive; }
+}
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void irqInit(XScuGic * gic)
+{
+	irqGic = gic;
+
+	XScuGic_WriteReg(gic->Config->CpuBaseAddress, XSCUGIC_BIN_PT_OFFSET, IRQ_BINARY_POINT);
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT, (Xil_ExceptionHandler) irqDispatch, gic);
+}
+
+s32 irqConnect(u32 id, Xil_InterruptHandler handler, void * callbackRef, u8 priority, u8 trigger, const char * strName)
+{
+	s32 status;
+	IrqSource_s * source;
+
+	if((id >= XSCUGIC_MAX_NUM_INTR_INPUTS) || (nIrqSources >= IRQ_SOURCES_MAX)) { return XST_FAILURE; }
+
+	status = XScuGic_Connect(irqGic, id, handler, callbackRef);
+	if(status != XST_SUCCESS) { return status; }
+	XScuGic_SetPriorityTriggerType(irqGic, id, priority, trigger);
+
+	source = &irqSource[nIrqSources++];
+	memset(source, 0, sizeof(IrqSource_s));
+	source->strName = strName;
+	source->id = id;
+	source->priority = priority;
+	irqSourceByID[id] = source;
+
+	XScuGic_Enable(irqGic, id);
+
+	return XST_SUCCESS;
+}
+
+void irqPrintStats(void)
+{
+	char strResult[160];
+	IrqSource_s * source;
+	IrqSource_s * other;
+	u64 tMean, tBound, tSameMax;
+
+	sprintf(strResult, "IRQ: max depth %u, dispatch overhead max %llu cycles, %u spurious.\r\n",
+			irqDepthMax, irqMaskedMax, nIrqSpurious);
+	xil_printf(strResult);
+	xil_printf("name            id  pri  calls      preempt    mean[us]  excl[us]  incl[us]  bound[us]\r\n");
+
+	for(u32 i = 0; i < nIrqSources; i++)
+	{
+		source = &irqSource[i];
+		tMean = source->nCalls ? (source->tExclusiveSum / source->nCalls) : 0;
+
+		// Worst-case latency bound: one pass of every higher-priority handler, plus the longest same-priority one.
+		tBound = irqMaskedMax;
+		tSameMax = 0;
+		for(u32 j = 0; j < nIrqSources; j++)
+		{
+			other = &irqSource[j];
+			if(j == i) { continue; }
+			if((other->priority >> 3) < (source->priority >> 3)) { tBound += other->tExclusiveMax; }
+			else if(((other->priority >> 3) == (source->priority >> 3)) && (other->tExclusiveMax > tSameMax))
+			{ tSameMax = other->tExclusiveMax; }
+		}
+		tBound += tSameMax;
+
+		sprintf(strResult, "%-15s %3u 0x%02X %-10u %-10u %-9llu %-9llu %-9llu %llu\r\n",
+				source->strName, source->id, source->priority, source->nCalls, source->nPreemptions,
+				tMean / IRQ_CYCLES_PER_US, source->tExclusiveMax / IRQ_CYCLES_PER_US,
+				source->tInclusiveMax / IRQ_CYCLES_PER_US, tBound / IRQ_CYCLES_PER_US);
+		xil_printf(strResult);
+
+		// Reset. Not atomic with the dispatcher, but a torn sample only affects one line of statistics.
+		source->nCalls = 0;
+		source->nPreemptions = 0;
+		source->tExclusiveSum = 0;
+		source->tExclusiveMax = 0;
+		source->tInclusiveMax = 0;
+	}
+
+	irqDepthMax = 0;
+	irqMaskedMax = 0;
+	nIrqSpurious = 0;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+OCM_TEXT void irqSaveFP(IrqFPContext_s * context)
+{
+	asm volatile(
+		"stp q0, q1, [%0, #0]\n"
+		"stp q2, q3, [%0, #32]\n"
+		"stp q4, q5, [%0, #64]\n"
+		"stp q6, q7, [%0, #96]\n"
+		"stp q8, q9, [%0, #128]\n"
+		"stp q10, q11, [%0, #160]\n"
+		"stp q12, q13, [%0, #192]\n"
+		"stp q14, q15, [%0, #224]\n"
+		"stp q16, q17, [%0, #256]\n"
+		"stp q18, q19, [%0, #288]\n"
+		"stp q20, q21, [%0, #320]\n"
+		"stp q22, q23, [%0, #352]\n"
+		"stp q24, q25, [%0, #384]\n"
+		"stp q26, q27, [%0, #416]\n"
+		"stp q28, q29, [%0, #448]\n"
+		"stp q30, q31, [%0, #480]\n"
+		: : "r" (context->q) : "memory");
+	asm volatile("mrs %0, fpcr" : "=r" (context->fpcr));
+	asm volatile("mrs %0, fpsr" : "=r" (context->fpsr));
+}
+
+OCM_TEXT void irqRestoreFP(IrqFPContext_s * context)
+{
+	asm volatile("msr fpcr, %0" : : "r" (context->fpcr));
+	asm volatile("msr fpsr, %0" : : "r" (context->fpsr));
+	asm volatile(
+		"ldp q0, q1, [%0, #0]\n"
+		"ldp q2, q3, [%0, #32]\n"
+		"ldp q4, q5, [%0, #64]\n"
+		"ldp q6, q7, [%0, #96]\n"
+		"ldp q8, q9, [%0, #128]\n"
+		"ldp q10, q11, [%0, #160]\n"
+		"ldp q12, q13, [%0, #192]\n"
+		"ldp q14, q15, [%0, #224]\n"
+		"ldp q16, q17, [%0, #256]\n"
+		"ldp q18, q19, [%0, #288]\n"
+		"ldp q20, q21, [%0, #320]\n"
+		"ldp q22, q23, [%0, #352]\n"
+		"ldp q24, q25, [%0, #384]\n"
+		"ldp q26, q27, [%0, #416]\n"
+		"ldp q28, q29, [%0, #448]\n"
+		"ldp q30, q31, [%0, #480]\n"
+		: : "r" (context->q) : "memory");
+}
@@ -0,0 +1,64 @@
+/*
+WAVE Interrupt Dispatcher Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __IRQ_INCLUDE__
+#define __IRQ_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "xscugic.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+// GIC priorities. Lower values preempt higher ones. The GIC compares only the group priority bits, [7:3] with the
+// binary point set by irqInit(), so levels must be at least 0x08 apart to nest.
+#define IRQ_PRIORITY_FOT			0x00
+#define IRQ_PRIORITY_VSYNC			0x08
+#define IRQ_PRIORITY_GPIO			0x10
+#define IRQ_PRIORITY_IMU			0x18
+#define IRQ_PRIORITY_FOT_DEFERRED	0x20
+#define IRQ_PRIORITY_SUPERVISOR		0x28
+#define IRQ_PRIORITY_LOG			0x30
+
+// Trigger types, as passed to XScuGic_SetPriorityTriggerType().
+#define IRQ_TRIGGER_LEVEL			0x01
+#define IRQ_TRIGGER_EDGE			0x03
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+// Take over the IRQ exception from XScuGic_InterruptHandler(). Must be called after XScuGic_CfgInitialize().
+void irqInit(XScuGic * gic);
+
+// Connect, prioritize, and enable an interrupt, and start latency accounting for it.
+s32 irqConnect(u32 id, Xil_InterruptHandler handler, void * callbackRef, u8 priority, u8 trigger, const char * strName);
+
+// Print per-IRQ counts, handler times, and preemption statistics over UART, then reset them.
+void irqPrintStats(void);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,219 @@
+/*
+WAVE Log
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "log.h"
+#include "ring.h"
+#include "xuartps.h"
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define LOG_RING_SIZE 256			// Messages waiting to be formatted.
+#define LOG_TEXT_SIZE 4096			// Formatted bytes waiting for the UART.
+#define LOG_LINE_MAX 192
+
+#define LOG_UART_BASE STDOUT_BASEADDRESS	// The same UART as xil_printf().
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	const char * strFormat;
+	u64 arg[4];
+	volatile u32 seq;			// Ring index + 1 once the producer is done writing the message.
+} LogRecord_s;
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+u8 logFormatNext(char * strLine);
+void logUartTransfer(void);
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+u8 logLevel = LOG_LEVEL_INFO;
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+// Messages. Any number of producers claim slots by compare-and-swap on the head. The main loop is the only consumer.
+LogRecord_s logRing[LOG_RING_SIZE];
+u32 logHead = 0;
+u32 logTail = 0;
+u32 logDropped = 0;
+u32 logDroppedReported = 0;
+u8 logSynchronous = 1;
+
+// Formatted text. The main loop produces and the UART0 TX empty interrupt consumes.
+Ring_s logTextRing;
+u8 logTextSlots[LOG_TEXT_SIZE];
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+void isrLogUart(void * CallbackRef)
+{
+	logUartTransfer();
+}
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void logInit(void)
+{
+	ringInit(&logTextRing, logTextSlots, LOG_TEXT_SIZE, sizeof(u8));
+
+	logHead = 0;
+	logTail = 0;
+	logDropped = 0;
+	logDroppedReported = 0;
+	logSynchronous = 1;
+}
+
+void logStart(void)
+{
+	logSynchronous = 0;
+}
+
+OCM_TEXT void logPost(u8 level, const char * strFormat, u64 a0, u64 a1, u64 a2, u64 a3)
+{
+	u32 head;
+	LogRecord_s * record;
+
+	if(level > logLevel) { return; }
+
+	// During init there's nothing else to hold up, and a hang should still show the messages leading up to it.
+	if(logSynchronous)
+	{
+		xil_printf(strFormat, a0, a1, a2, a3);
+		return;
+	}
+
+	head = __atomic_load_n(&logHead, __ATOMIC_RELAXED);
+	do
+	{
+		if((head - __atomic_load_n(&logTail, __ATOMIC_ACQUIRE)) >= LOG_RING_SIZE)
+		{
+			__atomic_fetch_add(&logDropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+	}
+	while(!__atomic_compare_exchange_n(&logHead, &head, head + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	record = &logRing[head % LOG_RING_SIZE];
+	record->strFormat = strFormat;
+	record->arg[0] = a0;
+	record->arg[1] = a1;
+	record->arg[2] = a2;
+	record->arg[3] = a3;
+	__atomic_store_n(&record->seq, head + 1, __ATOMIC_RELEASE);
+}
+
+void logService(void)
+{
+	char strLine[LOG_LINE_MAX];
+	u8 nLine;
+
+	while((LOG_TEXT_SIZE - ringCount(&logTextRing)) >= LOG_LINE_MAX)
+	{
+		nLine = logFormatNext(strLine);
+		if(nLine == 0) { break; }
+		for(u8 i = 0; i < nLine; i++) { ringPush(&logTextRing, &strLine[i]); }
+	}
+
+	if(ringCount(&logTextRing) > 0) { XUartPs_WriteReg(LOG_UART_BASE, XUARTPS_IER_OFFSET, XUARTPS_IXR_TXEMPTY); }
+}
+
+u8 logPending(void)
+{
+	return (__atomic_load_n(&logHead, __ATOMIC_RELAXED) != logTail)
+	    || (__atomic_load_n(&logDropped, __ATOMIC_RELAXED) != logDroppedReported);
+}
+
+void logFlush(void)
+{
+	char strLine[LOG_LINE_MAX];
+	u8 nLine;
+	u8 byte;
+
+	// Take the text ring from the ISR and drain it by polling.
+	XUartPs_WriteReg(LOG_UART_BASE, XUARTPS_IDR_OFFSET, XUARTPS_IXR_TXEMPTY);
+	while(ringPop(&logTextRing, &byte)) { XUartPs_SendByte(LOG_UART_BASE, byte); }
+
+	while((nLine = logFormatNext(strLine)) > 0)
+	{
+		for(u8 i = 0; i < nLine; i++) { XUartPs_SendByte(LOG_UART_BASE, strLine[i]); }
+	}
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+// Format the oldest complete message, or a note about dropped ones, into strLine. Returns its length, or 0 if there's
+// nothing to format.
+u8 logFormatNext(char * strLine)
+{
+	LogRecord_s * record;
+	u32 nDropped;
+	int nLine;
+
+	record = &logRing[logTail % LOG_RING_SIZE];
+	if(__atomic_load_n(&record->seq, __ATOMIC_ACQUIRE) == (logTail + 1))
+	{
+		nLine = snprintf(strLine, LOG_LINE_MAX, record->strFormat,
+		                 record->arg[0], record->arg[1], record->arg[2], record->arg[3]);
+
+		// Hand the slot back to the producers.
+		__atomic_store_n(&logTail, logTail + 1, __ATOMIC_RELEASE);
+	}
+	else
+	{
+		nDropped = __atomic_load_n(&logDropped, __ATOMIC_RELAXED);
+		if(nDropped == logDroppedReported) { return 0; }
+		nLine = snprintf(strLine, LOG_LINE_MAX, "Log: %u messages dropped.\r\n", nDropped - logDroppedReported);
+		logDroppedReported = nDropped;
+	}
+
+	if(nLine < 0) { return 0; }
+	if(nLine >= LOG_LINE_MAX) { nLine = LOG_LINE_MAX - 1; }
+	return (u8) nLine;
+}
+
+// Fill the UART0 TX FIFO from the text ring.
+void logUartTransfer(void)
+{
+	u8 byte;
+
+	XUartPs_WriteReg(LOG_UART_BASE, XUARTPS_ISR_OFFSET, XUARTPS_IXR_TXEMPTY);
+
+	while(!XUartPs_IsTransmitFull(LOG_UART_BASE) && ringPop(&logTextRing, &byte))
+	{
+		XUartPs_WriteReg(LOG_UART_BASE, XUARTPS_FIFO_OFFSET, byte);
+	}
+
+	// Stop TX empty interrupts once the ring is drained. Re-check after masking: the main loop may have pushed more
+	// text and unmasked in between.
+	if(ringCount(&logTextRing) == 0)
+	{
+		XUartPs_WriteReg(LOG_UART_BASE, XUARTPS_IDR_OFFSET, XUARTPS_IXR_TXEMPTY);
+		if(ringCount(&logTextRing) > 0) { XUartPs_WriteReg(LOG_UART_BASE, XUARTPS_IER_OFFSET, XUARTPS_IXR_TXEMPTY); }
+	}
+}
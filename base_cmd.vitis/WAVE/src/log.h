@@ -0,0 +1,75 @@
+/*
+WAVE Log Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __LOG_INCLUDE__
+#define __LOG_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARNING 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+
+// Post a message with up to four arguments. Arguments are stored as raw 64-bit values and only formatted when the
+// log is drained, so they must be integers or pointers to strings that outlive the message (literals, static names).
+// No floats. The format string must also be a literal.
+#define LOG_ERROR(...) logPost(LOG_LEVEL_ERROR, LOG_ARGS(__VA_ARGS__, 0, 0, 0, 0, 0))
+#define LOG_WARNING(...) logPost(LOG_LEVEL_WARNING, LOG_ARGS(__VA_ARGS__, 0, 0, 0, 0, 0))
+#define LOG_INFO(...) logPost(LOG_LEVEL_INFO, LOG_ARGS(__VA_ARGS__, 0, 0, 0, 0, 0))
+#define LOG_DEBUG(...) logPost(LOG_LEVEL_DEBUG, LOG_ARGS(__VA_ARGS__, 0, 0, 0, 0, 0))
+
+#define LOG_ARGS(strFormat, a0, a1, a2, a3, ...) strFormat, (u64)(a0), (u64)(a1), (u64)(a2), (u64)(a3)
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+void logInit(void);
+
+// Switch from printing each message as it's posted to buffering them. Call once the UART0 interrupt is connected.
+void logStart(void);
+
+// Copy a message into the log ring. Safe to call from ISRs, the main loop, and the storage core. Never waits: if
+// the ring is full, the message is dropped and counted.
+void logPost(u8 level, const char * strFormat, u64 a0, u64 a1, u64 a2, u64 a3);
+
+// Format waiting messages into the UART0 transmit ring, as far as it has room. Main loop only.
+void logService(void);
+u8 logPending(void);
+
+// Format and send everything waiting, blocking on the UART. For shutdown, and before printing long reports.
+void logFlush(void);
+
+void isrLogUart(void * CallbackRef);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+extern u8 logLevel;
+
+#endif
@@ -46,21 +46,35 @@
 #include "frame.h"
 #include "camera_state.h"
 #include "cal.h"
+#include "verify.h"
+#include "memory_map.h"
+#include "trace.h"
+#include "irq.h"
+#include "storage.h"
+#include "sched.h"
+#include "perf.h"
+#include "log.h"
 
 #include "xscugic.h"
 #include "xil_cache.h"
 
 #define INTC_DEVICE_ID XPAR_SCUGIC_0_DEVICE_ID
 
-// Main loop services.
-#define MAIN_SERVICE_IDLE 0
-#define MAIN_SERVICE_CMV 1
-#define MAIN_SERVICE_SUPERVISOR 2
-#define MAIN_SERVICE_UI 3
-#define MAIN_SERVICE_HDMI 4
+// Main loop tasks.
+#define MAIN_TASK_UI 0
+#define MAIN_TASK_CMV 1
+#define MAIN_TASK_SUPERVISOR 2
+#define MAIN_TASK_HDMI 3
+#define MAIN_TASK_LOG 4
+#define MAIN_NUM_TASKS 5
+
+#define MAIN_VSYNC_PERIOD_US 16667
 
 void isrFOT(void * CallbackRef);
+void isrFOTDeferred(void * CallbackRef);
 void isrVSYNC(void * CallbackRef);
+void mainServiceUI(void);
+void psplUpdateTemp(u16 * psplTemp, float * psplTf);
 
 u16 * psTemp = (u16 *)((u64) 0xFFA50800);
 u16 * plTemp = (u16 *)((u64) 0xFFA50C00);
@@ -68,8 +82,20 @@ u16 * plTemp = (u16 *)((u64) 0xFFA50C00);
 XScuGic Gic;
 
 u32 triggerShutdown = 0;
-u32 mainServiceState = 0;
-u32 closeFileSystem = 0;
+
+// CMV, UI, and HDMI services are released together at VSYNC, and are due by the next one. The supervisor link is
+// serviced often enough to time out an unanswered request promptly, but never waits on the UART. The log is drained
+// whenever there's something in it, after everything else.
+OCM_DATA SchedTask_s mainTask[MAIN_NUM_TASKS] =
+{
+	// Name         Run                 Ready       Pri Period [us]           Deadline [us]         Budget [us]
+	{"UI",          mainServiceUI,      NULL,       0,  SCHED_APERIODIC,      MAIN_VSYNC_PERIOD_US, 2000},
+	{"CMV",         cmvService,         NULL,       1,  SCHED_APERIODIC,      MAIN_VSYNC_PERIOD_US, 1000},
+	{"Supervisor",  supervisorService,  NULL,       2,  10000,                10000,                100},
+	{"HDMI",        hdmiService,        NULL,       3,  SCHED_APERIODIC,      MAIN_VSYNC_PERIOD_US, 1000},
+	{"Log",         logService,         logPending, 4,  SCHED_APERIODIC,      100000,               500}
+};
+Sched_s mainSched;
 
 u32 wQueue = 0;
 u32 wQueueMax = 0;
@@ -77,14 +103,22 @@ u32 lprQueue = 0;
 u32 lprQueueMax = 0;
 u32 hprQueue = 0;
 u32 hprQueueMax = 0;
+volatile u8 ddrQueueMaxResetRequest = 0;
+float psTf = -100.0f;		// Filtered temperatures in [C], -100 until the first update.
+float plTf = -100.0f;
+PerfCounter_s * perfDDRWriteQueue;
+PerfCounter_s * perfDDRLPRQueue;
+PerfCounter_s * perfDDRHPRQueue;
 int main()
 {
 	XScuGic_Config *gicConfig;
 	u32 nvmeStatus;
-	char strResult[128];
 
+    memMapInitOCM();
     init_platform();
-    Xil_DCacheDisable();
+    memMapInitCache();
+    traceInit();
+    logInit();
 
     // QSPI Flash Setup
     *(u32 *)((u64) 0xFF0F0014) = 0x00000000;	// Disable LQSPI.
@@ -99,27 +133,29 @@ int main()
     // Configure peripherals.
     gpioInit();
     supervisorInit();
-    xil_printf("WAVE HELLO!\r\n");
+    LOG_INFO("WAVE HELLO!\r\n");
+    memMapInit();
+    perfDDRWriteQueue = perfRegister("ddr.wq", "entries");
+    perfDDRLPRQueue = perfRegister("ddr.lprq", "entries");
+    perfDDRHPRQueue = perfRegister("ddr.hprq", "entries");
     calInit();
     cStateInit();
     waveletInit();
     encoderInit();
-    cmvInit();
     pcieInit();
 
     // NVMe initialize and status check.
     nvmeStatus = nvmeInit();
     if (nvmeStatus == NVME_OK)
     {
-    	xil_printf("NVMe initialization successful. PCIe link is Gen3 x4.\r\n");
+    	LOG_INFO("NVMe initialization successful. PCIe link is Gen3 x4.\r\n");
     }
     else
     {
-    	sprintf(strResult, "NVMe driver failed to initialize. Error Code: %8x\r\n", nvmeStatus);
-    	xil_printf(strResult);
+    	LOG_ERROR("NVMe driver failed to initialize. Error Code: %8x\r\n", nvmeStatus);
     	if(nvmeStatus == NVME_ERROR_PHY)
     	{
-    		xil_printf("PCIe link must be Gen3 x4.\r\n");
+    		LOG_ERROR("PCIe link must be Gen3 x4.\r\n");
     	}
     }
 
@@ -128,117 +164,138 @@ int main()
     // Global interrupt controller setup and enable.
     gicConfig = XScuGic_LookupConfig(INTC_DEVICE_ID);
     XScuGic_CfgInitialize(&Gic, gicConfig, gicConfig->CpuBaseAddress);
-    Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT, (Xil_ExceptionHandler) XScuGic_InterruptHandler, &Gic);
-
-    // NOTE: By default, XScuGic DOES NOT support nested interrupts.
+    irqInit(&Gic);
 
-    // Configure and enable FOT interrupt (Highest Priority: 0x00).
-    XScuGic_Connect(&Gic, 124, (Xil_ExceptionHandler) isrFOT, (void *) &Gic);
-    XScuGic_SetPriorityTriggerType(&Gic, 124, 0x00, 0x03);
-    XScuGic_Enable(&Gic, 124);
-
-    // Configure and enable VSYNC interrupt (Second Highest Priority: 0x08).
-    XScuGic_Connect(&Gic, 125, (Xil_ExceptionHandler) isrVSYNC, (void *) &Gic);
-    XScuGic_SetPriorityTriggerType(&Gic, 125, 0x08, 0x03);
-    XScuGic_Enable(&Gic, 125);
-
-    // Configure and enable the UI/GPIO interrupt (Third Highest Priority: 0x10).
-    XScuGic_Connect(&Gic, 48, (Xil_ExceptionHandler)XGpioPs_IntrHandler, (void *) &Gpio);
-    XScuGic_SetPriorityTriggerType(&Gic, 48, 0x10, 0x01);
-    XScuGic_Enable(&Gic, 48);
+    // Interrupts preempt each other by priority. The firmware's dispatcher handles nesting, not the BSP.
+    irqConnect(124, (Xil_InterruptHandler) isrFOT, (void *) &Gic, IRQ_PRIORITY_FOT, IRQ_TRIGGER_EDGE, "FOT");
+    irqConnect(125, (Xil_InterruptHandler) isrVSYNC, (void *) &Gic, IRQ_PRIORITY_VSYNC, IRQ_TRIGGER_EDGE, "VSYNC");
+    irqConnect(48, (Xil_InterruptHandler) XGpioPs_IntrHandler, (void *) &Gpio, IRQ_PRIORITY_GPIO, IRQ_TRIGGER_LEVEL, "GPIO");
+    irqConnect(52, (Xil_InterruptHandler) XSpiPs_InterruptHandler, (void *) &Spi1, IRQ_PRIORITY_IMU, IRQ_TRIGGER_LEVEL, "IMU");
+    irqConnect(FRAME_FOT_SGI, (Xil_InterruptHandler) isrFOTDeferred, (void *) &Gic, IRQ_PRIORITY_FOT_DEFERRED, IRQ_TRIGGER_LEVEL, "FOT deferred");
+    irqConnect(54, (Xil_InterruptHandler) isrSupervisorUart, NULL, IRQ_PRIORITY_SUPERVISOR, IRQ_TRIGGER_LEVEL, "Supervisor UART");
+    irqConnect(53, (Xil_InterruptHandler) isrLogUart, NULL, IRQ_PRIORITY_LOG, IRQ_TRIGGER_LEVEL, "Log UART");
 
     Xil_ExceptionEnable();
 
+    // From here on, log messages are buffered and sent by the UART0 interrupt.
+    logStart();
+
     usleep(1000);
 
     fsInit();
+
+    // Link training is binned by PL temperature.
+    psplUpdateTemps();
+
+    // After fsInit(), so link training can use the results cached on the SSD.
+    cmvInit();
+    cmvUpdateTemp();
+    nvmeUpdateTemp();
+
     hdmiInit();
     usbInit();
     frameInit();
     uiInit();
     imuInit();
 
+    // From here on, the SSD belongs to the storage core.
+    storageInit();
+
+    schedInit(&mainSched, "main", mainTask, MAIN_NUM_TASKS);
+
     // Main loop.
     while(!triggerShutdown)
     {
-    	usbPoll();
-
-    	if(cState.cSetting[CSETTING_MODE]->val == CSETTING_MODE_REC)
-    	{
-    		frameAddToClip();
-    	}
-
-    	// Main loop service state machine.
-    	switch(mainServiceState)
-    	{
-    	case MAIN_SERVICE_CMV:
-    		cmvService();
-    		mainServiceState = MAIN_SERVICE_SUPERVISOR;
-    		break;
-    	case MAIN_SERVICE_SUPERVISOR:
-    		supervisorService();
-    		mainServiceState = MAIN_SERVICE_UI;
-    		break;
-    	case MAIN_SERVICE_UI:
-    		uiService();
-    		mainServiceState = MAIN_SERVICE_HDMI;
-    		wQueue = (*(u32*)0xFD070308 >> 16) & 0xFF;
-    		if(wQueue > wQueueMax) { wQueueMax = wQueue; }
-    		lprQueue = (*(u32*)0xFD070308 >> 8) & 0xFF;
-    		if(lprQueue > lprQueueMax) { lprQueueMax = lprQueue; }
-    		hprQueue = (*(u32*)0xFD070308 >> 0) & 0xFF;
-    		if(hprQueue > hprQueueMax) { hprQueueMax = hprQueue; }
-    		break;
-    	case MAIN_SERVICE_HDMI:
-    		hdmiService();
-    		mainServiceState = MAIN_SERVICE_IDLE;
-    	case MAIN_SERVICE_IDLE:
-    	default:
-    		mainServiceState = MAIN_SERVICE_IDLE;
-    		break;
-    	}
+    	schedService(&mainSched);
 
-    	if(cState.cSetting[CSETTING_FORMAT]->val == CSETTING_FORMAT_CONFIRM)
+    	if((cState.cSetting[CSETTING_FORMAT]->val == CSETTING_FORMAT_CONFIRM)
+    	&& (frameRecState == FRAME_REC_STATE_IDLE))
     	{
     		cState.cSetting[CSETTING_FORMAT]->val = CSETTING_FORMAT_CANCEL;
-    		fsFormat();
+    		storageRequestFormat();
     	}
 
-    	if(closeFileSystem)
+    	// Measure the SSD write rate without formatting. Writes and deletes a 256MiB file.
+    	if((cState.cSetting[CSETTING_FORMAT]->val == CSETTING_FORMAT_BENCHMARK)
+    	&& (frameRecState == FRAME_REC_STATE_IDLE))
     	{
-    		closeFileSystem = 0;
-    		fsDeinit();
+    		cState.cSetting[CSETTING_FORMAT]->val = CSETTING_FORMAT_CANCEL;
+    		storageRequestBenchmark();
     	}
     }
 
-    fsDeinit();
+    storageShutdown();
+    logFlush();
     cleanup_platform();
     return 0;
 }
 
-void mainServiceTrigger(void)
+OCM_TEXT void mainServiceTrigger(void)
+{
+	schedRelease(&mainTask[MAIN_TASK_UI]);
+	schedRelease(&mainTask[MAIN_TASK_CMV]);
+	schedRelease(&mainTask[MAIN_TASK_HDMI]);
+}
+
+void mainServiceUI(void)
+{
+	// The temperature filters are only stepped here. Everything else, including the storage core, reads them.
+	psplUpdateTemps();
+	cmvUpdateTemp();
+	nvmeUpdateTemp();
+
+	uiService();
+
+	if(__atomic_exchange_n(&ddrQueueMaxResetRequest, 0, __ATOMIC_RELAXED))
+	{
+		wQueueMax = 0;
+		lprQueueMax = 0;
+		hprQueueMax = 0;
+	}
+
+	wQueue = (*(u32*)0xFD070308 >> 16) & 0xFF;
+	if(wQueue > wQueueMax) { wQueueMax = wQueue; }
+	perfSample(perfDDRWriteQueue, wQueue);
+	lprQueue = (*(u32*)0xFD070308 >> 8) & 0xFF;
+	if(lprQueue > lprQueueMax) { lprQueueMax = lprQueue; }
+	perfSample(perfDDRLPRQueue, lprQueue);
+	hprQueue = (*(u32*)0xFD070308 >> 0) & 0xFF;
+	if(hprQueue > hprQueueMax) { hprQueueMax = hprQueue; }
+	perfSample(perfDDRHPRQueue, hprQueue);
+}
+
+void mainResetDDRQueueMax(void)
+{
+	ddrQueueMaxResetRequest = 1;
+}
+
+// Step the PS and PL temperature filters. Core 0 only, once per UI pass.
+void psplUpdateTemps(void)
 {
-	mainServiceState = MAIN_SERVICE_CMV;
+	psplUpdateTemp(psTemp, &psTf);
+	psplUpdateTemp(plTemp, &plTf);
 }
 
+// Last filtered PS (psTemp) or PL (plTemp) temperature in [C]. Safe from either core.
 float psplGetTemp(u16 * psplTemp)
+{
+	return (psplTemp == plTemp) ? plTf : psTf;
+}
+
+void psplUpdateTemp(u16 * psplTemp, float * psplTf)
 {
 	// TO-DO: Move to calibration.
 	static float psDN0 = 0.0f;
 	static float psT0 = -280.2f;
 	static float psTSlope = 7.772E-3f;
 
-	static float psTf = -100.0f;
-
 	float psT = (*psplTemp - psDN0) * psTSlope + psT0;
-	if(psTf == -100.0f)
+	if(*psplTf == -100.0f)
 	{
-		psTf = psT;
+		*psplTf = psT;
 	}
 	else
 	{
-		psTf = 0.95f * psTf + 0.05f * psT;
+		*psplTf = 0.95f * *psplTf + 0.05f * psT;
 	}
-
-	return psTf;
 }
@@ -35,11 +35,17 @@ THE SOFTWARE.
 #include "xil_cache.h"
 #include "xtime_l.h"
 #include "sleep.h"
+#include "sched.h"
 
 // Public Pre-Processor Definitions ------------------------------------------------------------------------------------
 
 #define US_PER_COUNT 1000 / (COUNTS_PER_SECOND / 1000)
 
+// On-chip memory (OCM) placement for interrupt handlers, their call trees, and their working state, so they don't
+// compete with encoder and HDMI DDR4 traffic. Copied from DDR4 by memMapInitOCM(). Not for const objects.
+#define OCM_TEXT __attribute__((section(".ocm_text")))
+#define OCM_DATA __attribute__((section(".ocm_data")))
+
 // Public Type Definitions ---------------------------------------------------------------------------------------------
 
 typedef struct __attribute__((packed))
@@ -52,11 +58,20 @@ typedef struct __attribute__((packed))
 // Public Function Prototypes ------------------------------------------------------------------------------------------
 
 void mainServiceTrigger(void);
+void psplUpdateTemps(void);
 float psplGetTemp(u16 * psplTemp);
 
+// Start a new DDR controller queue high-water mark window. Applied by the next mainServiceUI() on core 0, which owns
+// the maxima, so it's safe to call from the storage core.
+void mainResetDDRQueueMax(void);
+
 // Externed Public Global Variables ------------------------------------------------------------------------------------
 
 extern u16 * psTemp;
 extern u16 * plTemp;
+extern u32 wQueueMax;
+extern u32 lprQueueMax;
+extern u32 hprQueueMax;
+extern Sched_s mainSched;
 
 #endif
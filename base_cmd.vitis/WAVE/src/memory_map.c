@@ -0,0 +1,196 @@
+/*
+WAVE DDR4 Memory Map
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "memory_map.h"
+#include "xil_cache.h"
+#include "xil_mmu.h"
+#include "log.h"
+#include <string.h>
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+u64 memMapAlignDown(u64 addr);
+u64 memMapAlignUp(u64 addr);
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+// OCM section boundaries and DDR4 load addresses, from lscript.ld.
+extern u8 __ocm_text_start[];
+extern u8 __ocm_text_end[];
+extern u8 __ocm_text_load[];
+extern u8 __ocm_data_start[];
+extern u8 __ocm_data_end[];
+extern u8 __ocm_data_load[];
+
+const MemMapRegion_s memMapRegion[MEM_MAP_NUM_REGIONS] =
+{
+	{"Program",          MEM_MAP_PROGRAM_BASE,       MEM_MAP_PROGRAM_SIZE,        1},
+	{"NVMe Queues",      MEM_MAP_NVME_QUEUE_BASE,    MEM_MAP_NVME_QUEUE_SIZE,     0},
+	{"NVMe Identify",    MEM_MAP_NVME_ID_BASE,       MEM_MAP_NVME_ID_SIZE,        0},
+	{"NVMe PRP Lists",   MEM_MAP_NVME_PRP_BASE,      MEM_MAP_NVME_PRP_SIZE,       0},
+	{"Frame Headers",    MEM_MAP_FH_BASE,            MEM_MAP_FH_SIZE,             0},
+	{"Clip Info",        MEM_MAP_CLIP_INFO_BASE,     MEM_MAP_CLIP_INFO_SIZE,      0},
+	{"Telemetry",        MEM_MAP_TELEMETRY_BASE,     MEM_MAP_TELEMETRY_SIZE,      0},
+	{"Verify Headers",   MEM_MAP_VERIFY_HEADER_BASE, MEM_MAP_VERIFY_HEADER_SIZE,  0},
+	{"Verify Data",      MEM_MAP_VERIFY_CS_BASE,     MEM_MAP_VERIFY_CS_SIZE,      0},
+	{"Codestreams",      MEM_MAP_CS_BASE,            MEM_MAP_CS_SIZE,             0},
+	{"SSD to USB",       MEM_MAP_SSD2USB_BASE,       MEM_MAP_SSD2USB_SIZE,        0},
+	{"USB to SSD",       MEM_MAP_USB2SSD_BASE,       MEM_MAP_USB2SSD_SIZE,        0},
+	{"OCM",              MEM_MAP_OCM_BASE,           MEM_MAP_OCM_SIZE,            1}
+};
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void memMapInitOCM(void)
+{
+	u64 sizeText = __ocm_text_end - __ocm_text_start;
+	u64 sizeData = __ocm_data_end - __ocm_data_start;
+
+	memcpy(__ocm_text_start, __ocm_text_load, sizeText);
+	memcpy(__ocm_data_start, __ocm_data_load, sizeData);
+
+	// Copied code must reach OCM before it is fetched.
+	Xil_DCacheFlushRange((INTPTR)__ocm_text_start, sizeText);
+	Xil_DCacheFlushRange((INTPTR)__ocm_data_start, sizeData);
+	Xil_ICacheInvalidate();
+}
+
+void memMapInitCache(void)
+{
+	u64 addr, end;
+
+	// Attributes are changed with the D-Cache off, so no dirty lines are left behind in non-cacheable regions.
+	Xil_DCacheDisable();
+
+	for(int i = 0; i < MEM_MAP_NUM_REGIONS; i++)
+	{
+		if(memMapRegion[i].cacheable) { continue; }
+		end = memMapAlignUp(memMapRegion[i].base + memMapRegion[i].size);
+		for(addr = memMapAlignDown(memMapRegion[i].base); addr < end; addr += MEM_MAP_MMU_BLOCK_SIZE)
+		{
+			Xil_SetTlbAttributes(addr, NORM_NONCACHE);
+		}
+	}
+
+#if MEM_MAP_DCACHE_ENABLE
+	Xil_DCacheEnable();
+#endif
+}
+
+u32 memMapInit(void)
+{
+	u32 nErrors = 0;
+	u64 endA, endB;
+
+	for(int a = 0; a < MEM_MAP_NUM_REGIONS; a++)
+	{
+		endA = memMapRegion[a].base + memMapRegion[a].size;
+		if((a != MEM_MAP_ID_OCM) && (endA > MEM_MAP_DDR_SIZE))
+		{
+			LOG_ERROR("Error: Memory region %s is outside of DDR4.\r\n", memMapRegion[a].strName);
+			nErrors++;
+		}
+
+		for(int b = a + 1; b < MEM_MAP_NUM_REGIONS; b++)
+		{
+			endB = memMapRegion[b].base + memMapRegion[b].size;
+			if((memMapRegion[a].base < endB) && (memMapRegion[b].base < endA))
+			{
+				LOG_ERROR("Error: Memory regions %s and %s overlap.\r\n", memMapRegion[a].strName, memMapRegion[b].strName);
+				nErrors++;
+			}
+		}
+	}
+
+	// Non-cacheable regions must not share an MMU block with a cacheable region.
+	for(int a = 0; a < MEM_MAP_NUM_REGIONS; a++)
+	{
+		if(memMapRegion[a].cacheable) { continue; }
+		for(int b = 0; b < MEM_MAP_NUM_REGIONS; b++)
+		{
+			if(!memMapRegion[b].cacheable) { continue; }
+			endA = memMapAlignUp(memMapRegion[a].base + memMapRegion[a].size);
+			endB = memMapAlignUp(memMapRegion[b].base + memMapRegion[b].size);
+			if((memMapAlignDown(memMapRegion[a].base) < endB) && (memMapAlignDown(memMapRegion[b].base) < endA))
+			{
+				LOG_ERROR("Error: Memory regions %s and %s share a cache block.\r\n", memMapRegion[a].strName, memMapRegion[b].strName);
+				nErrors++;
+			}
+		}
+	}
+
+	if(nErrors == 0) { LOG_INFO("Memory map check successful.\r\n"); }
+
+	return nErrors;
+}
+
+u64 memMapGetBase(u8 id)
+{
+	if(id >= MEM_MAP_NUM_REGIONS) { return 0; }
+	return memMapRegion[id].base;
+}
+
+u64 memMapGetSize(u8 id)
+{
+	if(id >= MEM_MAP_NUM_REGIONS) { return 0; }
+	return memMapRegion[id].size;
+}
+
+u8 memMapContains(u8 id, u64 base, u64 size)
+{
+	if(id >= MEM_MAP_NUM_REGIONS) { return 0; }
+	return (base >= memMapRegion[id].base) && ((base + size) <= (memMapRegion[id].base + memMapRegion[id].size));
+}
+
+u8 memMapIsCacheable(u64 base)
+{
+	for(int i = 0; i < MEM_MAP_NUM_REGIONS; i++)
+	{
+		if((base >= memMapRegion[i].base) && (base < (memMapRegion[i].base + memMapRegion[i].size)))
+		{ return memMapRegion[i].cacheable; }
+	}
+	return 0;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+u64 memMapAlignDown(u64 addr)
+{
+	return addr & ~((u64)MEM_MAP_MMU_BLOCK_SIZE - 1);
+}
+
+u64 memMapAlignUp(u64 addr)
+{
+	return memMapAlignDown(addr + MEM_MAP_MMU_BLOCK_SIZE - 1);
+}
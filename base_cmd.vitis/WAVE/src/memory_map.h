@@ -0,0 +1,122 @@
+/*
+WAVE DDR4 Memory Map Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __MEMORY_MAP_INCLUDE__
+#define __MEMORY_MAP_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+// External DDR4 Regions
+// Pointers into these regions are initialized at compile time, since ISRs can use them before any init function
+// runs. The region table built from these definitions is checked for overlaps by memMapInit().
+// Only the program region (code, stack, heap, FatFs state) is cacheable. Every other region is shared with DMA
+// or the PL and is mapped non-cacheable. DMA to or from the program region needs explicit cache maintenance.
+// PL register windows (0x80000000 and up) are already mapped as device memory by the BSP translation table.
+// D-Cache enable. Set to 0 to run fully uncached, for timing comparisons.
+#define MEM_MAP_DCACHE_ENABLE			1
+
+// MMU attributes can only be set per 2MiB block. Non-cacheable regions must not share a block with a cacheable one.
+#define MEM_MAP_MMU_BLOCK_SIZE			0x00200000
+
+#define MEM_MAP_DDR_SIZE				0x80000000
+
+#define MEM_MAP_PROGRAM_BASE			0x00000000		// Must match psu_ddr_0_MEM_0 in lscript.ld.
+#define MEM_MAP_PROGRAM_SIZE			0x10000000
+#define MEM_MAP_NVME_QUEUE_BASE			0x10000000		// Admin and I/O submission and completion queues.
+#define MEM_MAP_NVME_QUEUE_SIZE			0x00004000
+#define MEM_MAP_NVME_ID_BASE			0x10004000		// Identify and SMART log structures.
+#define MEM_MAP_NVME_ID_SIZE			0x00003000
+#define MEM_MAP_NVME_PRP_BASE			0x10008000		// PRP list heap, one page per I/O queue entry.
+#define MEM_MAP_NVME_PRP_SIZE			0x00040000
+#define MEM_MAP_FH_BASE					0x18000000		// Frame header circular buffer.
+#define MEM_MAP_FH_SIZE					0x00200000
+#define MEM_MAP_CLIP_INFO_BASE			0x18200000		// Staged clip info file contents.
+#define MEM_MAP_CLIP_INFO_SIZE			0x00100000
+#define MEM_MAP_TELEMETRY_BASE			0x18300000		// Telemetry sample circular buffer.
+#define MEM_MAP_TELEMETRY_SIZE			0x00010000
+#define MEM_MAP_VERIFY_HEADER_BASE		0x18400000		// Read-back verifier frame headers.
+#define MEM_MAP_VERIFY_HEADER_SIZE		0x00020000
+#define MEM_MAP_VERIFY_CS_BASE			0x18420000		// Read-back verifier codestream data.
+#define MEM_MAP_VERIFY_CS_SIZE			0x02000000
+#define MEM_MAP_CS_BASE					0x20000000		// Encoder codestream buffers.
+#define MEM_MAP_CS_SIZE					0x4E000000
+#define MEM_MAP_SSD2USB_BASE			0x70000000		// USB mass storage read buffer.
+#define MEM_MAP_SSD2USB_SIZE			0x08000000
+#define MEM_MAP_USB2SSD_BASE			0x78000000		// USB mass storage write buffer.
+#define MEM_MAP_USB2SSD_SIZE			0x08000000
+
+#define MEM_MAP_OCM_BASE				0xFFFC0000		// On-chip memory. Must match psu_ocm_ram_0_MEM_0 in lscript.ld.
+#define MEM_MAP_OCM_SIZE				0x00040000
+
+// Region IDs
+#define MEM_MAP_ID_PROGRAM				0
+#define MEM_MAP_ID_NVME_QUEUE			1
+#define MEM_MAP_ID_NVME_ID				2
+#define MEM_MAP_ID_NVME_PRP				3
+#define MEM_MAP_ID_FH					4
+#define MEM_MAP_ID_CLIP_INFO			5
+#define MEM_MAP_ID_TELEMETRY			6
+#define MEM_MAP_ID_VERIFY_HEADER		7
+#define MEM_MAP_ID_VERIFY_CS			8
+#define MEM_MAP_ID_CS					9
+#define MEM_MAP_ID_SSD2USB				10
+#define MEM_MAP_ID_USB2SSD				11
+#define MEM_MAP_ID_OCM					12		// Not in DDR4. Holds the stack, OCM_TEXT, and OCM_DATA.
+#define MEM_MAP_NUM_REGIONS				13
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	const char * strName;
+	u64 base;
+	u64 size;
+	u8 cacheable;
+} MemMapRegion_s;
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+// Check the region table for overlaps and out-of-range regions. Returns the number of problems found.
+u32 memMapInit(void);
+
+// Apply region cache attributes to the MMU table and enable the D-Cache. Call first thing after init_platform().
+void memMapInitCache(void);
+
+// Copy OCM_TEXT and OCM_DATA from their DDR4 load image into OCM. Call first thing in main(), before any interrupts.
+void memMapInitOCM(void);
+
+u64 memMapGetBase(u8 id);
+u64 memMapGetSize(u8 id);
+
+// Check that a buffer lies entirely within a region.
+u8 memMapContains(u8 id, u64 base, u64 size);
+u8 memMapIsCacheable(u64 base);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+#endif
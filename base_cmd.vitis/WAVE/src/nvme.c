@@ -27,6 +27,9 @@ THE SOFTWARE.
 #include "xil_printf.h"
 #include "nvme.h"
 #include "nvme_priv.h"
+#include "memory_map.h"
+#include "trace.h"
+#include "perf.h"
 #include "xil_cache.h"
 #include "xil_mmu.h"
 #include "sleep.h"
@@ -74,6 +77,10 @@ int nvmeCheckTimeout(XTime tStart, u32 tTimeout_ms);
 
 // Private Global Variables --------------------------------------------------------------------------------------------
 
+PerfCounter_s * perfNVMeSlip;		// IO commands in flight at each submission.
+
+float nvmeTf = -100.0f;				// Filtered composite temperature in [C], -100 until the first update.
+
 // AXI/PCIE Bridge and Device Registers
 u32 * regPhyStatusControl =      (u32 *)(0x500000144);
 u32 * regRootPortStatusControl = (u32 *)(0x500000148);
@@ -94,19 +101,19 @@ u32 * regCQ1HDBL = (u32 *)(0xB000100C);					// I/O Completion Queue Head Doorbel
 
 // Submission and Completion Queues
 // Must be page-aligned at least large enough to fit the queue sizes defined above.
-sqe_prp_type * asq =  (sqe_prp_type *)(0x10000000);		// Admin Submission Queue
-cqe_type * acq =          (cqe_type *)(0x10001000);		// Admin Completion Queue
-sqe_prp_type * iosq = (sqe_prp_type *)(0x10002000);		// I/O Submission Queue
-cqe_type * iocq =         (cqe_type *)(0x10003000);		// I/O Completion Queue
+sqe_prp_type * asq =  (sqe_prp_type *)(MEM_MAP_NVME_QUEUE_BASE + 0x0000);		// Admin Submission Queue
+cqe_type * acq =          (cqe_type *)(MEM_MAP_NVME_QUEUE_BASE + 0x1000);		// Admin Completion Queue
+sqe_prp_type * iosq = (sqe_prp_type *)(MEM_MAP_NVME_QUEUE_BASE + 0x2000);		// I/O Submission Queue
+cqe_type * iocq =         (cqe_type *)(MEM_MAP_NVME_QUEUE_BASE + 0x3000);		// I/O Completion Queue
 
 // Identify Structures
-idController_type * idController = (idController_type *)(0x10004000);
-idNamespace_type * idNamespace = (idNamespace_type *)(0x10005000);
-logSMARTHealth_type * logSMARTHealth = (logSMARTHealth_type *)(0x10006000);
+idController_type * idController = (idController_type *)(MEM_MAP_NVME_ID_BASE + 0x0000);
+idNamespace_type * idNamespace = (idNamespace_type *)(MEM_MAP_NVME_ID_BASE + 0x1000);
+logSMARTHealth_type * logSMARTHealth = (logSMARTHealth_type *)(MEM_MAP_NVME_ID_BASE + 0x2000);
 
 // Heap space for PRP lists for IO Transfers.
 // Heap size is (IOSQ_SIZE + 1) * DDR_PAGE_SIZE.
-u64 * prpListHeap = (u64 *)(0x10008000);
+u64 * prpListHeap = (u64 *)(MEM_MAP_NVME_PRP_BASE);
 
 descPowerState_type descPowerState[32];
 
@@ -133,6 +140,7 @@ u16 io_cid_last_completed = 0xFFFF;
 int nvmeInit(void)
 {
 	nvmeStatus = NVME_OK;
+	perfNVMeSlip = perfRegister("nvme.slip", "cmds");
 
 	nvmeStatus |= nvmeInitBridge();
 	if(nvmeStatus != NVME_OK) { return nvmeStatus; }
@@ -185,15 +193,14 @@ int nvmeGetMetrics(void)
 	return nvmeGetSMARTHealth();
 }
 
-float nvmeGetTemp(void)
+// Step the SSD temperature filter from the last metrics sample. Core 0 only, once per UI pass.
+void nvmeUpdateTemp(void)
 {
 	// TO-DO: Move to calibration.
 	static float nvmeDN0 = 0.0f;
 	static float nvmeT0 = -273.15f;
 	static float nvmeTSlope = 1.0f;
 
-	static float nvmeTf = -100.0f;
-
 	float nvmeT = (logSMARTHealth->Composite_Temperature - nvmeDN0) * nvmeTSlope + nvmeT0;
 	if(nvmeTf == -100.0f)
 	{
@@ -203,10 +210,27 @@ float nvmeGetTemp(void)
 	{
 		nvmeTf = 0.95f * nvmeTf + 0.05f * nvmeT;
 	}
+}
 
+// Last filtered SSD temperature in [C]. Safe from either core.
+float nvmeGetTemp(void)
+{
 	return nvmeTf;
 }
 
+// Warning composite temperature threshold (WCTEMP) in [C], above which the drive starts to protect itself.
+float nvmeGetTempWarning(void)
+{
+	if(idController->WCTEMP == 0) { return NVME_TEMP_WARNING_DEFAULT; }
+	return (float)(idController->WCTEMP) - 273.15f;
+}
+
+// SMART critical warning temperature flag, from the last metrics sample.
+u8 nvmeGetThermalWarning(void)
+{
+	return (logSMARTHealth->Critical_Warning & 0x02) ? 1 : 0;
+}
+
 int nvmeWrite(const u8 * srcByte, u64 destLBA, u32 numLBA)
 {
 	sqe_prp_type sqe;
@@ -671,6 +695,8 @@ void nvmeSubmitIOCommand(const sqe_prp_type * sqe)
 	memcpy((void *)((u64)iosq + iosq_offset), sqe, sizeof(sqe_prp_type));
 	iosq_tail_local = (iosq_tail_local + 1) & IOSQ_SIZE;
 	io_cid++;
+	traceEvent(TRACE_NVME_SUBMIT, sqe->CID);
+	perfSample(perfNVMeSlip, nvmeGetIOSlip());
 
 	isb(); dsb(); // Xil_DCacheFlush();
 	*regSQ1TDBL = iosq_tail_local;
@@ -693,6 +719,7 @@ int nvmeCompleteIOCommands(cqe_type * cqe, u16 nCompletionsMax)
 		if((cqeTemp->SF_P & 0x0001) == iocq_phase) { break; }
 
 		io_cid_last_completed = cqeTemp->CID;
+		traceEvent(TRACE_NVME_COMPLETE, cqeTemp->CID);
 
 		iocq_head_local = (iocq_head_local + 1) & IOCQ_SIZE;
 		if(iocq_head_local == 0) { iocq_phase ^= 0x01; }
@@ -50,6 +50,9 @@ THE SOFTWARE.
 #define NVME_RW_OK                         0x00000000
 #define NVME_RW_BAD_ALIGNMENT              0x00000001
 
+// Assumed warning composite temperature if the controller doesn't report one.
+#define NVME_TEMP_WARNING_DEFAULT          70.0f
+
 // Public Type Definitions ---------------------------------------------------------------------------------------------
 
 // Public Function Prototypes ------------------------------------------------------------------------------------------
@@ -59,7 +62,10 @@ int nvmeGetStatus(void);
 u64 nvmeGetLBACount(void);
 u16 nvmeGetLBASize(void);
 int nvmeGetMetrics(void);
+void nvmeUpdateTemp(void);
 float nvmeGetTemp(void);
+float nvmeGetTempWarning(void);
+u8 nvmeGetThermalWarning(void);
 
 int nvmeWrite(const u8 * srcByte, u64 destLBA, u32 numLBA);
 int nvmeFlush();
@@ -7,6 +7,7 @@ ZU+ PL PCIe (XDMA Bridge) Driver
 #include "pcie.h"
 #include "xdmapcie.h"
 #include "supervisor.h"
+#include "log.h"
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
 
@@ -62,14 +63,17 @@ void pcieInit(void)
 	int pcieStatus;
 
 	// Enable SSD power.
-	supervisorEnableSSDPower();
+	if(supervisorEnableSSDPower() != SUPERVISOR_OK)
+	{
+		LOG_WARNING("Warning: SSD power good timed out.\r\n");
+	}
 	usleep(1000);
 
 	/* Initialize Root Complex */
 	pcieStatus = PcieInitRootComplex(&XdmaPcieInstance, XDMAPCIE_DEVICE_ID);
 	if (pcieStatus != XST_SUCCESS)
 	{
-		xil_printf("Warning: PCIe initialization failed.\r\n");
+		LOG_WARNING("Warning: PCIe initialization failed.\r\n");
 		return;
 	}
 
@@ -99,13 +103,13 @@ int PcieInitRootComplex(XDmaPcie *XdmaPciePtr, u16 DeviceId)
 						ConfigPtr->BaseAddress);
 
 	if (Status != XST_SUCCESS) {
-		xil_printf("Failed to initialize PCIe Root Complex"
+		LOG_ERROR("Failed to initialize PCIe Root Complex"
 							"IP Instance\r\n");
 		return XST_FAILURE;
 	}
 
 	if(!XdmaPciePtr->Config.IncludeRootComplex) {
-		xil_printf("Failed to initialize...XDMA PCIE is configured"
+		LOG_ERROR("Failed to initialize...XDMA PCIE is configured"
 							" as endpoint\r\n");
 		return XST_FAILURE;
 	}
@@ -150,11 +154,11 @@ int PcieInitRootComplex(XDmaPcie *XdmaPciePtr, u16 DeviceId)
                 usleep(XDMAPCIE_LINK_WAIT_USLEEP_MIN);
 	}
 	if (Status != TRUE ) {
-		xil_printf("Warning: PCIe link is not up.\r\n");
+		LOG_WARNING("Warning: PCIe link is not up.\r\n");
 		return XST_FAILURE;
 	}
 
-	xil_printf("PCIe link is up.\r\n");
+	LOG_INFO("PCIe link is up.\r\n");
 
 	/*
 	 * Read back requester ID.
@@ -162,7 +166,7 @@ int PcieInitRootComplex(XDmaPcie *XdmaPciePtr, u16 DeviceId)
 	XDmaPcie_GetRequesterId(XdmaPciePtr, &BusNumber,
 				&DeviceNumber, &FunNumber, &PortNumber);
 
-	xil_printf("Bus Number: %02X\r\n"
+	LOG_DEBUG("Bus Number: %02X\r\n"
 			"Device Number: %02X\r\n"
 				"Function Number: %02X\r\n"
 					"Port Number: %02X\r\n",
@@ -188,7 +192,7 @@ int PcieInitRootComplex(XDmaPcie *XdmaPciePtr, u16 DeviceId)
 	XDmaPcie_ReadLocalConfigSpace(XdmaPciePtr,
 					PCIE_CFG_CMD_STATUS_REG, &HeaderData);
 
-	xil_printf("PCIe Local Config Space is %8X at register"
+	LOG_DEBUG("PCIe Local Config Space is %8X at register"
 					" CommandStatus\r\n", HeaderData);
 
 	/*
@@ -207,12 +211,12 @@ int PcieInitRootComplex(XDmaPcie *XdmaPciePtr, u16 DeviceId)
 	XDmaPcie_ReadLocalConfigSpace(XdmaPciePtr,
 					PCIE_CFG_PRI_SEC_BUS_REG, &HeaderData);
 
-	xil_printf("PCIe Local Config Space is %8X at register "
+	LOG_DEBUG("PCIe Local Config Space is %8X at register "
 					"Prim Sec. Bus\r\n", HeaderData);
 
 	/* Now it is ready to function */
 
-	xil_printf("PCIe initialization successful.\r\n");
+	LOG_INFO("PCIe initialization successful.\r\n");
 
 	return XST_SUCCESS;
 }
@@ -0,0 +1,202 @@
+/*
+WAVE Performance Counters
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "perf.h"
+#include <string.h>
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define PERF_COUNTERS_MAX 32
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+void perfGetStats(PerfCounter_s * counter, PerfExportRecord_s * record);
+u32 perfGetBin(u32 value);
+u32 perfGetBinMax(u32 iBin);
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+OCM_DATA PerfCounter_s perfCounter[PERF_COUNTERS_MAX];
+u32 nPerfCounters = 0;
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+PerfCounter_s * perfRegister(const char * strName, const char * strUnit)
+{
+	PerfCounter_s * counter;
+
+	if(nPerfCounters >= PERF_COUNTERS_MAX) { return NULL; }
+
+	counter = &perfCounter[nPerfCounters++];
+	memset(counter, 0, sizeof(PerfCounter_s));
+	counter->strName = strName;
+	counter->strUnit = strUnit;
+	counter->min = 0xFFFFFFFF;
+
+	return counter;
+}
+
+OCM_TEXT void perfSample(PerfCounter_s * counter, u32 value)
+{
+	u32 iBin;
+
+	if(counter == NULL) { return; }
+
+	if(counter->resetRequest)
+	{
+		counter->n = 0;
+		counter->min = 0xFFFFFFFF;
+		counter->max = 0;
+		counter->sum = 0;
+		memset(counter->hist, 0, sizeof(counter->hist));
+		counter->resetRequest = 0;
+	}
+
+	counter->n++;
+	counter->sum += value;
+	if(value < counter->min) { counter->min = value; }
+	if(value > counter->max) { counter->max = value; }
+
+	iBin = perfGetBin(value);
+	counter->hist[iBin]++;
+}
+
+void perfResetAll(void)
+{
+	for(u32 i = 0; i < nPerfCounters; i++)
+	{
+		perfCounter[i].resetRequest = 1;
+	}
+}
+
+void perfPrint(void)
+{
+	char strResult[128];
+	PerfExportRecord_s record;
+
+	xil_printf("counter         unit     n          min        mean       p99<=      max\r\n");
+	for(u32 i = 0; i < nPerfCounters; i++)
+	{
+		perfGetStats(&perfCounter[i], &record);
+		sprintf(strResult, "%-15s %-8s %-10u %-10u %-10u %-10u %u\r\n", perfCounter[i].strName, perfCounter[i].strUnit,
+				record.n, record.min, record.mean, record.p99, record.max);
+		xil_printf(strResult);
+	}
+}
+
+u32 perfExport(u8 * buffer, u32 size)
+{
+	PerfExportHeader_s * header = (PerfExportHeader_s *) buffer;
+	PerfExportRecord_s * record = (PerfExportRecord_s *) (buffer + sizeof(PerfExportHeader_s));
+	XTime tNow;
+	u32 nCounters;
+
+	if(size < sizeof(PerfExportHeader_s)) { return 0; }
+
+	nCounters = (size - sizeof(PerfExportHeader_s)) / sizeof(PerfExportRecord_s);
+	if(nCounters > nPerfCounters) { nCounters = nPerfCounters; }
+
+	XTime_GetTime(&tNow);
+	memcpy(header->strMagic, "PERF", 4);
+	header->version = PERF_EXPORT_VERSION;
+	header->nCounters = (u16) nCounters;
+	header->tExport_us = tNow * US_PER_COUNT;
+
+	for(u32 i = 0; i < nCounters; i++)
+	{
+		memset(&record[i], 0, sizeof(PerfExportRecord_s));
+		strncpy(record[i].strName, perfCounter[i].strName, sizeof(record[i].strName));
+		strncpy(record[i].strUnit, perfCounter[i].strUnit, sizeof(record[i].strUnit));
+		perfGetStats(&perfCounter[i], &record[i]);
+	}
+
+	return sizeof(PerfExportHeader_s) + nCounters * sizeof(PerfExportRecord_s);
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+// Summarize a counter's window. Read without locking; a sample landing mid-read only skews that one line.
+void perfGetStats(PerfCounter_s * counter, PerfExportRecord_s * record)
+{
+	u32 n, nCumulative;
+
+	record->n = 0;
+	record->min = 0;
+	record->max = 0;
+	record->mean = 0;
+	record->p99 = 0;
+
+	n = counter->n;
+	if(counter->resetRequest || (n == 0)) { return; }
+
+	record->n = n;
+	record->min = counter->min;
+	record->max = counter->max;
+	record->mean = (u32)(counter->sum / n);
+
+	nCumulative = 0;
+	for(u32 i = 0; i < PERF_HIST_BINS; i++)
+	{
+		nCumulative += counter->hist[i];
+		if(100ull * nCumulative >= 99ull * n)
+		{
+			record->p99 = perfGetBinMax(i);
+			break;
+		}
+	}
+	if(record->p99 > record->max) { record->p99 = record->max; }
+}
+
+// Histogram bin for a value: the top PERF_HIST_SUB_BITS + 1 significant bits.
+OCM_TEXT u32 perfGetBin(u32 value)
+{
+	u32 exp, sub;
+
+	if(value < (1u << PERF_HIST_SUB_BITS)) { return value; }
+
+	exp = 31 - __builtin_clz(value);
+	sub = (value >> (exp - PERF_HIST_SUB_BITS)) & ((1u << PERF_HIST_SUB_BITS) - 1);
+	return ((exp - PERF_HIST_SUB_BITS + 1) << PERF_HIST_SUB_BITS) + sub;
+}
+
+// Largest value that lands in a histogram bin.
+u32 perfGetBinMax(u32 iBin)
+{
+	u32 exp, sub;
+
+	if(iBin < (1u << PERF_HIST_SUB_BITS)) { return iBin; }
+
+	exp = (iBin >> PERF_HIST_SUB_BITS) + PERF_HIST_SUB_BITS - 1;
+	sub = iBin & ((1u << PERF_HIST_SUB_BITS) - 1);
+	return (u32)((((u64)(1u << PERF_HIST_SUB_BITS) + sub + 1) << (exp - PERF_HIST_SUB_BITS)) - 1);
+}
@@ -0,0 +1,94 @@
+/*
+WAVE Performance Counters Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __PERF_INCLUDE__
+#define __PERF_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+// Log-linear histogram: values 0-3 get a bin each, then every power of two is split into 4 equal sub-bins, so a
+// percentile read from it overstates the true value by at most 25%.
+#define PERF_HIST_SUB_BITS 2
+#define PERF_HIST_BINS 124
+#define PERF_EXPORT_VERSION 1
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	const char * strName;
+	const char * strUnit;
+	volatile u8 resetRequest;	// Set by readers, applied by the next sample.
+	u32 n;
+	u32 min;
+	u32 max;
+	u64 sum;
+	u32 hist[PERF_HIST_BINS];	// See perfGetBin().
+} PerfCounter_s;
+
+// Export format, for reading over USB. Little-endian, one record per counter after the header.
+typedef struct __attribute__((packed))
+{
+	char strMagic[4];			// "PERF"
+	u16 version;
+	u16 nCounters;
+	u64 tExport_us;
+} PerfExportHeader_s;
+
+typedef struct __attribute__((packed))
+{
+	char strName[16];
+	char strUnit[8];
+	u32 n;
+	u32 min;
+	u32 max;
+	u32 mean;
+	u32 p99;					// Upper bound of the bin holding the 99th percentile, at most 25% high.
+	u32 reserved;
+} PerfExportRecord_s;
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+// Add a counter to the registry. Call during init, on core 0. Returns NULL if the registry is full.
+PerfCounter_s * perfRegister(const char * strName, const char * strUnit);
+
+// Add a sample to a counter. Each counter must only be sampled from one core.
+void perfSample(PerfCounter_s * counter, u32 value);
+
+// Start a new window for every counter.
+void perfResetAll(void);
+
+// Print the registry over UART.
+void perfPrint(void);
+
+// Write a snapshot of the registry to a buffer. Returns the number of bytes written.
+u32 perfExport(u8 * buffer, u32 size);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+#endif
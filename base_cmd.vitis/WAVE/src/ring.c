@@ -0,0 +1,106 @@
+/*
+WAVE Single-Producer/Single-Consumer Ring
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "ring.h"
+#include <string.h>
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+// Full-system barrier. Ring items may describe data in non-cacheable DDR4, outside the inner shareable domain.
+// Host builds of the ring test use a compiler fence instead.
+#if defined(__aarch64__)
+#define RING_BARRIER() asm volatile("dmb sy" : : : "memory")
+#else
+#define RING_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void ringInit(Ring_s * ring, void * slots, u32 nSlots, u32 szSlot)
+{
+	ring->head = 0;
+	ring->nOverruns = 0;
+	ring->tail = 0;
+	ring->nSlots = nSlots;
+	ring->szSlot = szSlot;
+	ring->slots = (u8 *) slots;
+}
+
+OCM_TEXT u8 ringPush(Ring_s * ring, const void * item)
+{
+	u32 head = ring->head;
+
+	if((head - ring->tail) >= ring->nSlots)
+	{
+		ring->nOverruns++;
+		return 0;
+	}
+
+	// The consumer is done with the slot once it has moved the tail past it.
+	RING_BARRIER();
+	memcpy(&ring->slots[(head % ring->nSlots) * ring->szSlot], item, ring->szSlot);
+
+	// Publish the item, and everything written before it, only once it's complete.
+	RING_BARRIER();
+	ring->head = head + 1;
+
+	return 1;
+}
+
+OCM_TEXT u8 ringPop(Ring_s * ring, void * item)
+{
+	u32 tail = ring->tail;
+
+	if(ring->head == tail) { return 0; }
+
+	// Read the item, and anything it describes, only after seeing the head that published it.
+	RING_BARRIER();
+	memcpy(item, &ring->slots[(tail % ring->nSlots) * ring->szSlot], ring->szSlot);
+
+	// Release the slot only once the item has been read.
+	RING_BARRIER();
+	ring->tail = tail + 1;
+
+	return 1;
+}
+
+OCM_TEXT u32 ringCount(const Ring_s * ring)
+{
+	return ring->head - ring->tail;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+/*
+WAVE Single-Producer/Single-Consumer Ring Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __RING_INCLUDE__
+#define __RING_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+// Lock-free ring of fixed-size items between exactly one producer and one consumer, which may be an ISR and a
+// main loop or two cores. Head and tail are free-running counts on separate cache lines.
+typedef struct
+{
+	volatile u32 head __attribute__((aligned(64)));		// Items pushed. Written by the producer only.
+	u32 nOverruns;										// Pushes dropped because the ring was full.
+	volatile u32 tail __attribute__((aligned(64)));		// Items popped. Written by the consumer only.
+	u32 nSlots;
+	u32 szSlot;
+	u8 * slots;
+} Ring_s;
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+void ringInit(Ring_s * ring, void * slots, u32 nSlots, u32 szSlot);
+
+// Copy an item into the ring. Returns 0 and counts an overrun if the ring is full. Producer only.
+u8 ringPush(Ring_s * ring, const void * item);
+
+// Copy the oldest item out of the ring. Returns 0 if the ring is empty. Consumer only.
+u8 ringPop(Ring_s * ring, void * item);
+
+u32 ringCount(const Ring_s * ring);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+#endif
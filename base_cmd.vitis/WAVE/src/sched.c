@@ -0,0 +1,203 @@
+/*
+WAVE Cooperative Scheduler
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "sched.h"
+#include "trace.h"
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define SCHED_COUNTS_PER_US (COUNTS_PER_SECOND / 1000000)
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+u8 schedIsLate(const SchedTask_s * task, XTime tNow);
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void schedInit(Sched_s * sched, const char * strName, SchedTask_s * task, u32 nTasks)
+{
+	XTime tNow;
+
+	XTime_GetTime(&tNow);
+
+	sched->strName = strName;
+	sched->task = task;
+	sched->nTasks = nTasks;
+	sched->tStats = tNow;
+	sched->iTraced = nTasks;
+
+	for(u32 i = 0; i < nTasks; i++)
+	{
+		task[i].released = 0;
+		task[i].tNextRelease = tNow;
+		if(task[i].deadline_us == 0) { task[i].deadline_us = task[i].period_us; }
+	}
+}
+
+OCM_TEXT void schedRelease(SchedTask_s * task)
+{
+	XTime tNow;
+
+	if(task->released) { return; }
+
+	XTime_GetTime(&tNow);
+	task->tRelease = tNow;
+	task->tDeadline = tNow + (XTime) task->deadline_us * SCHED_COUNTS_PER_US;
+	task->released = 1;
+}
+
+void schedService(Sched_s * sched)
+{
+	XTime tNow, tStart, tEnd, tRun;
+	SchedTask_s * task;
+	SchedTask_s * next = NULL;
+	u32 iNext = 0;
+
+	XTime_GetTime(&tNow);
+
+	// Release tasks that are due by period, or that have work.
+	for(u32 i = 0; i < sched->nTasks; i++)
+	{
+		task = &sched->task[i];
+		if(task->released) { continue; }
+
+		if((task->period_us != SCHED_APERIODIC) && (tNow >= task->tNextRelease))
+		{
+			task->tRelease = task->tNextRelease;
+			task->tDeadline = task->tRelease + (XTime) task->deadline_us * SCHED_COUNTS_PER_US;
+			task->released = 1;
+
+			// Releases missed while the task was pending are dropped, not queued up.
+			task->tNextRelease += (XTime) task->period_us * SCHED_COUNTS_PER_US;
+			if(task->tNextRelease <= tNow) { task->tNextRelease = tNow + (XTime) task->period_us * SCHED_COUNTS_PER_US; }
+		}
+		else if((task->ready != NULL) && task->ready())
+		{
+			schedRelease(task);
+		}
+	}
+
+	// Late tasks go earliest deadline first, ahead of any priority, so no task starves for longer than its
+	// deadline. Otherwise, highest priority first.
+	for(u32 i = 0; i < sched->nTasks; i++)
+	{
+		task = &sched->task[i];
+		if(!task->released) { continue; }
+
+		if(next == NULL)
+		{ next = task; iNext = i; }
+		else if(schedIsLate(task, tNow) || schedIsLate(next, tNow))
+		{
+			if(schedIsLate(task, tNow) && (!schedIsLate(next, tNow) || (task->tDeadline < next->tDeadline)))
+			{ next = task; iNext = i; }
+		}
+		else if((task->priority < next->priority)
+		     || ((task->priority == next->priority) && (task->tDeadline < next->tDeadline)))
+		{ next = task; iNext = i; }
+	}
+
+	if(next == NULL) { return; }
+
+	// A release that arrives while the task runs is kept for the next pass.
+	next->released = 0;
+	if(schedIsLate(next, tNow)) { next->nLate++; }
+	if((tNow - next->tRelease) > next->tLatencyMax) { next->tLatencyMax = tNow - next->tRelease; }
+
+	// A task that's always ready, like storage idle work, would otherwise flush the trace ring within milliseconds.
+	if(iNext != sched->iTraced)
+	{
+		traceEvent(TRACE_SERVICE, iNext);
+		sched->iTraced = iNext;
+	}
+	XTime_GetTime(&tStart);
+	next->run();
+	XTime_GetTime(&tEnd);
+
+	tRun = tEnd - tStart;
+	next->nRuns++;
+	next->tRunSum += tRun;
+	if(tRun > next->tRunMax) { next->tRunMax = tRun; }
+	if(tRun > (XTime) next->budget_us * SCHED_COUNTS_PER_US) { next->nOverBudget++; }
+}
+
+void schedPrintStats(Sched_s * sched)
+{
+	char strResult[160];
+	SchedTask_s * task;
+	XTime tNow, tWindow;
+	float share, shareTotal = 0.0f;
+
+	XTime_GetTime(&tNow);
+	tWindow = tNow - sched->tStats;
+	if(tWindow == 0) { return; }
+
+	sprintf(strResult, "Scheduler %s: %llu ms window.\r\n", sched->strName, tWindow / SCHED_COUNTS_PER_US / 1000);
+	xil_printf(strResult);
+	xil_printf("task        pri  period[us] runs      mean[us]  max[us]   budget[us] over  late  lat[us]   share\r\n");
+
+	for(u32 i = 0; i < sched->nTasks; i++)
+	{
+		task = &sched->task[i];
+		share = 100.0f * (float) task->tRunSum / (float) tWindow;
+		shareTotal += share;
+
+		sprintf(strResult, "%-11s %-4u %-10u %-9u %-9llu %-9llu %-10u %-5u %-5u %-9llu %5.1f%%\r\n",
+				task->strName, task->priority, task->period_us, task->nRuns,
+				task->nRuns ? (task->tRunSum / task->nRuns / SCHED_COUNTS_PER_US) : 0,
+				task->tRunMax / SCHED_COUNTS_PER_US, task->budget_us, task->nOverBudget, task->nLate,
+				task->tLatencyMax / SCHED_COUNTS_PER_US, share);
+		xil_printf(strResult);
+
+		// Reset. Not atomic with another core's scheduler, but a torn sample only affects one line of statistics.
+		task->nRuns = 0;
+		task->nLate = 0;
+		task->nOverBudget = 0;
+		task->tRunSum = 0;
+		task->tRunMax = 0;
+		task->tLatencyMax = 0;
+	}
+
+	sprintf(strResult, "Loop overhead and idle: %5.1f%%\r\n", 100.0f - shareTotal);
+	xil_printf(strResult);
+
+	sched->tStats = tNow;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+u8 schedIsLate(const SchedTask_s * task, XTime tNow)
+{
+	return (tNow > task->tDeadline);
+}
@@ -0,0 +1,88 @@
+/*
+WAVE Cooperative Scheduler Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __SCHED_INCLUDE__
+#define __SCHED_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+#define SCHED_APERIODIC 0		// Released only by schedRelease() or the task's ready() function.
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	// Configuration.
+	const char * strName;
+	void (*run)(void);
+	u8 (*ready)(void);			// Optional. Releases the task whenever it returns non-zero.
+	u8 priority;				// Lower values run first, unless another released task is past its deadline.
+	u32 period_us;				// Timer release period, or SCHED_APERIODIC.
+	u32 deadline_us;			// Relative to release.
+	u32 budget_us;				// Expected worst-case run time. Tasks aren't preempted, so overruns are only counted.
+
+	// State.
+	volatile u8 released;
+	XTime tRelease;
+	XTime tDeadline;
+	XTime tNextRelease;
+
+	// Statistics, since the last schedPrintStats().
+	u32 nRuns;
+	u32 nLate;					// Runs started past their deadline.
+	u32 nOverBudget;
+	XTime tRunSum;
+	XTime tRunMax;
+	XTime tLatencyMax;			// Longest time from release to run.
+} SchedTask_s;
+
+typedef struct
+{
+	const char * strName;
+	SchedTask_s * task;
+	u32 nTasks;
+	XTime tStats;				// Start of the statistics window.
+	u32 iTraced;				// Task in the last TRACE_SERVICE record.
+} Sched_s;
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+void schedInit(Sched_s * sched, const char * strName, SchedTask_s * task, u32 nTasks);
+
+// Release an aperiodic task. Safe to call from ISRs on the scheduler's core.
+void schedRelease(SchedTask_s * task);
+
+// Run at most one released task: the earliest deadline of any that are late, otherwise the highest priority.
+void schedService(Sched_s * sched);
+
+// Print per-task run time, share of wall time, lateness, and budget overruns over UART, then reset them.
+void schedPrintStats(Sched_s * sched);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+#endif
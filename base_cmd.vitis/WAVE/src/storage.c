@@ -0,0 +1,239 @@
+/*
+WAVE Storage Core
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "storage.h"
+#include "frame.h"
+#include "fs.h"
+#include "verify.h"
+#include "usb.h"
+#include "trace.h"
+#include "sched.h"
+#include "log.h"
+#include "xil_cache.h"
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define STORAGE_STACK_SIZE			0x8000
+
+// Longest wait for the storage core to close the file system at shutdown.
+#define STORAGE_SHUTDOWN_TIMEOUT_US	5000000
+
+// Storage core tasks.
+#define STORAGE_NUM_TASKS			3
+
+// Core 1 reset vector and reset control (ZynqMP TRM, APU and CRF_APB registers).
+#define STORAGE_RVBARADDR1L			0xFD5C0048
+#define STORAGE_RVBARADDR1H			0xFD5C004C
+#define STORAGE_RST_FPD_APU			0xFD1A0104
+#define STORAGE_ACPU1_RESET			0x00000002
+#define STORAGE_ACPU1_PWRON_RESET	0x00000800
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+// System register state the storage core copies from core 0 before it can run C code. Offsets are used by
+// storageEntry, so don't reorder.
+typedef struct __attribute__((aligned(64)))
+{
+	u64 sp;
+	u64 vbar;
+	u64 mair;
+	u64 tcr;
+	u64 ttbr0;
+	u64 sctlr;
+} StorageBoot_s;
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+void storageEntry(void);
+void storageMain(void);
+void storageServiceIdle(void);
+u8 storageIdleReady(void);
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+u32 closeFileSystem = 0;
+Sched_s storageSched;
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+// Recording runs ahead of everything else whenever it has work. USB is still polled within its deadline.
+SchedTask_s storageTask[STORAGE_NUM_TASKS] =
+{
+	// Name         Run                 Ready               Pri Period [us]      Deadline [us]  Budget [us]
+	{"Record",      frameAddToClip,     frameRecordPending, 0,  SCHED_APERIODIC, 10000,         20000},
+	{"USB",         usbPoll,            NULL,               1,  1000,            5000,          1000},
+	{"Idle",        storageServiceIdle, storageIdleReady,   2,  SCHED_APERIODIC, 100000,        50000}
+};
+
+StorageBoot_s storageBoot;
+u8 storageStack[STORAGE_STACK_SIZE] __attribute__((aligned(16)));
+
+volatile u8 storageFormatRequest = 0;
+volatile u8 storageBenchmarkRequest = 0;
+volatile u8 storageShutdownRequest = 0;
+volatile u8 storageStopped = 0;
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void storageInit(void)
+{
+	u64 entry = (u64) storageEntry;
+
+	// Core 1 shares core 0's exception vectors and translation tables, and has its own stack.
+	storageBoot.sp = (u64) &storageStack[STORAGE_STACK_SIZE];
+	asm volatile("mrs %0, vbar_el3" : "=r" (storageBoot.vbar));
+	asm volatile("mrs %0, mair_el3" : "=r" (storageBoot.mair));
+	asm volatile("mrs %0, tcr_el3" : "=r" (storageBoot.tcr));
+	asm volatile("mrs %0, ttbr0_el3" : "=r" (storageBoot.ttbr0));
+	asm volatile("mrs %0, sctlr_el3" : "=r" (storageBoot.sctlr));
+
+	// Core 1 reads these with its MMU and caches off.
+	Xil_DCacheFlushRange((INTPTR) &storageBoot, sizeof(StorageBoot_s));
+
+	// Release core 1 from reset at storageEntry. The FSBL leaves all APU cores powered up.
+	Xil_Out32(STORAGE_RVBARADDR1L, (u32)(entry & 0xFFFFFFFF));
+	Xil_Out32(STORAGE_RVBARADDR1H, (u32)(entry >> 32));
+	asm volatile("dsb sy");
+	Xil_Out32(STORAGE_RST_FPD_APU, Xil_In32(STORAGE_RST_FPD_APU) & ~(STORAGE_ACPU1_RESET | STORAGE_ACPU1_PWRON_RESET));
+
+	LOG_INFO("Storage core started.\r\n");
+}
+
+void storageRequestFormat(void)
+{
+	storageFormatRequest = 1;
+}
+
+void storageRequestBenchmark(void)
+{
+	storageBenchmarkRequest = 1;
+}
+
+void storageShutdown(void)
+{
+	XTime tStart, tNow;
+
+	storageShutdownRequest = 1;
+
+	XTime_GetTime(&tStart);
+	while(!storageStopped)
+	{
+		XTime_GetTime(&tNow);
+		if(((tNow - tStart) * US_PER_COUNT) >= STORAGE_SHUTDOWN_TIMEOUT_US)
+		{
+			LOG_ERROR("Error: Storage core didn't stop. File system may not be closed.\r\n");
+			return;
+		}
+	}
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+/*
+Storage Core Reset Entry
+- Runs at EL3 with the MMU and caches off. Joins the SMP coherency domain, then turns on the MMU and caches with
+  core 0's settings, so shared variables and cacheable buffers are coherent between the cores.
+- IRQs stay masked on core 1. All interrupts are routed to core 0.
+*/
+asm(
+	".section .text\n"
+	".balign 64\n"
+	".global storageEntry\n"
+	"storageEntry:\n"
+	"	ldr x0, =storageBoot\n"
+	"	ldr x1, [x0, #0]\n"
+	"	mov sp, x1\n"
+	"	ldr x1, [x0, #8]\n"
+	"	msr vbar_el3, x1\n"
+	"	msr cptr_el3, xzr\n"				// No FP/SIMD traps.
+	"	mrs x1, S3_1_C15_C2_1\n"			// CPUECTLR_EL1.SMPEN
+	"	orr x1, x1, #0x40\n"
+	"	msr S3_1_C15_C2_1, x1\n"
+	"	ldr x1, [x0, #16]\n"
+	"	msr mair_el3, x1\n"
+	"	ldr x1, [x0, #24]\n"
+	"	msr tcr_el3, x1\n"
+	"	ldr x1, [x0, #32]\n"
+	"	msr ttbr0_el3, x1\n"
+	"	tlbi alle3\n"
+	"	dsb sy\n"
+	"	isb\n"
+	"	ldr x1, [x0, #40]\n"
+	"	msr sctlr_el3, x1\n"
+	"	isb\n"
+	"	bl storageMain\n"
+	"1:	wfe\n"
+	"	b 1b\n"
+	".ltorg\n"
+);
+
+// Storage core main loop. Everything that touches the SSD runs here, away from the UI and peripheral services.
+void storageMain(void)
+{
+	traceInitCore();
+	schedInit(&storageSched, "storage", storageTask, STORAGE_NUM_TASKS);
+
+	while(!storageShutdownRequest)
+	{
+		schedService(&storageSched);
+	}
+
+	fsDeinit();
+	storageStopped = 1;
+}
+
+// Clip staging, read-back verification, and file system maintenance, while not recording.
+void storageServiceIdle(void)
+{
+	frameAddToClip();
+
+	if(storageFormatRequest)
+	{
+		storageFormatRequest = 0;
+		verifyReset();
+		fsFormat();
+	}
+
+	if(storageBenchmarkRequest)
+	{
+		storageBenchmarkRequest = 0;
+		fsBenchmark();
+	}
+
+	if(closeFileSystem)
+	{
+		closeFileSystem = 0;
+		fsDeinit();
+	}
+}
+
+u8 storageIdleReady(void)
+{
+	return !frameRecordPending();
+}
@@ -0,0 +1,55 @@
+/*
+WAVE Storage Core Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __STORAGE_INCLUDE__
+#define __STORAGE_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+// Start the storage core (A53 core 1). From then on, only the storage core accesses the SSD: the record path,
+// FatFs, NVMe, and USB mass storage. Call once NVMe, FatFs, USB, and the frame module are initialized.
+void storageInit(void);
+
+// Ask the storage core to format the SSD once it's idle.
+void storageRequestFormat(void);
+
+// Ask the storage core to benchmark the SSD write rate once it's idle.
+void storageRequestBenchmark(void);
+
+// Close the file system and park the storage core. Blocks until it's done, or logs an error and gives up after 5s.
+void storageShutdown(void);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+extern Sched_s storageSched;
+
+#endif
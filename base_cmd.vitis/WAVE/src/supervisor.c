@@ -25,6 +25,7 @@ THE SOFTWARE.
 // Include Headers -----------------------------------------------------------------------------------------------------
 
 #include "supervisor.h"
+#include "ring.h"
 #include "xuartps.h"
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
@@ -44,13 +45,35 @@ THE SOFTWARE.
 #define SUPERVISOR_REPLY_ENPG_CMV 0x0E
 #define SUPERVISOR_REPLY_ENPG_SSD 0x01
 
+// Request types. Each request is one byte out and at most one byte back.
+#define SUPERVISOR_REQUEST_NONE 0
+#define SUPERVISOR_REQUEST_COMMAND 1
+#define SUPERVISOR_REQUEST_BATTERY 2
+
+#define SUPERVISOR_QUEUE_SIZE 8
+#define SUPERVISOR_RX_RING_SIZE 16
+#define SUPERVISOR_TX_RING_SIZE 16
+
+#define SUPERVISOR_REPLY_TIMEOUT_US 20000
+#define SUPERVISOR_BATTERY_PERIOD_US 100000
+#define SUPERVISOR_POWER_TIMEOUT_US 2000000
+#define SUPERVISOR_POWER_RESEND_US 10000
+
 // Private Type Definitions --------------------------------------------------------------------------------------------
 
 // Private Function Prototypes -----------------------------------------------------------------------------------------
 
+void supervisorQueue(u8 type);
+void supervisorProcess(void);
+void supervisorPoll(void);
+int supervisorWaitPowerGood(u8 enpg);
+void supervisorUartTransfer(void);
+
 // Public Global Variables ---------------------------------------------------------------------------------------------
 
 u8 supervisorVBatt = 120;
+u8 supervisorFanSpeed = SUPERVISOR_FAN_OFF;
+u32 supervisorTimeouts = 0;
 
 // Private Global Variables --------------------------------------------------------------------------------------------
 
@@ -61,9 +84,32 @@ XUartPs_Config *uart0Config;
 XUartPs_Config *uart1Config;
 
 u8 supervisor_command_en = 0;
+volatile u8 supervisorFanRequest = SUPERVISOR_FAN_NONE;
+
+// Requests waiting to be sent, and the one in flight. Main loop only.
+Ring_s supervisorRequestRing;
+u8 supervisorRequestSlots[SUPERVISOR_QUEUE_SIZE];
+u8 supervisorQueued = 0;						// Bit (1 << type) set while a request of that type is queued.
+u8 supervisorActive = SUPERVISOR_REQUEST_NONE;
+XTime tSupervisorSent = 0;
+XTime tSupervisorBattery = 0;
+
+// Last command reply, with its EN and PG flags.
+u8 supervisorReply = 0x00;
+
+// Bytes between the UART FIFOs and the protocol. The ISR produces RX and consumes TX.
+Ring_s supervisorRxRing;
+Ring_s supervisorTxRing;
+u8 supervisorRxSlots[SUPERVISOR_RX_RING_SIZE];
+u8 supervisorTxSlots[SUPERVISOR_TX_RING_SIZE];
 
 // Interrupt Handlers --------------------------------------------------------------------------------------------------
 
+void isrSupervisorUart(void * CallbackRef)
+{
+	supervisorUartTransfer();
+}
+
 // Public Function Definitions -----------------------------------------------------------------------------------------
 
 void supervisorInit()
@@ -78,60 +124,32 @@ void supervisorInit()
 	XUartPs_CfgInitialize(&Uart1, uart1Config, uart1Config->BaseAddress);
 	XUartPs_SetBaudRate(&Uart1, 115200);
 
+	ringInit(&supervisorRequestRing, supervisorRequestSlots, SUPERVISOR_QUEUE_SIZE, sizeof(u8));
+	ringInit(&supervisorRxRing, supervisorRxSlots, SUPERVISOR_RX_RING_SIZE, sizeof(u8));
+	ringInit(&supervisorTxRing, supervisorTxSlots, SUPERVISOR_TX_RING_SIZE, sizeof(u8));
+
+	// Interrupt on every received byte. TX empty is enabled only while there is something to send.
+	XUartPs_SetFifoThreshold(&Uart1, 1);
+	XUartPs_WriteReg(uart1Config->BaseAddress, XUARTPS_IDR_OFFSET, XUARTPS_IXR_MASK);
+	XUartPs_WriteReg(uart1Config->BaseAddress, XUARTPS_ISR_OFFSET, XUARTPS_IXR_MASK);
+	XUartPs_WriteReg(uart1Config->BaseAddress, XUARTPS_IER_OFFSET, XUARTPS_IXR_RXOVR);
+
 	supervisorSetFan(SUPERVISOR_FAN_HIGH);
 }
 
 int supervisorEnableCMVPower(void)
 {
-	u8 cmvPowerReady = 0x00;
-	u8 uart1Reply = 0x00;
-
 	supervisor_command_en |= SUPERVISOR_COMMAND_EN_CMV;
 
-	while(!cmvPowerReady)
-	{
-	   	XUartPs_SendByte(uart1Config->BaseAddress, SUPERVISOR_PREFIX_COMMAND | supervisor_command_en);
-	   	usleep(10000);
-	   	// uart1Reply = XUartPs_RecvByte(uart1Config->BaseAddress);
-	   	uart1Reply = XUartPs_ReadReg(uart1Config->BaseAddress, XUARTPS_FIFO_OFFSET);
-	   	if((uart1Reply & SUPERVISOR_PREFIX_MASK) == SUPERVISOR_PREFIX_REPLY)
-	   	{
-	   		// Reply prefix is valid, check EN and PG flags.
-	   		if((uart1Reply & SUPERVISOR_REPLY_ENPG_CMV) == SUPERVISOR_REPLY_ENPG_CMV)
-	   		{
-	   			// EN_CMV, PG_3V9, and PG_VDD18 are all set. Okay to proceed.
-	   			cmvPowerReady = 0x01;
-	   		}
-	   	}
-	}
-
-	return SUPERVISOR_OK;
+	// EN_CMV, PG_3V9, and PG_VDD18 must all be set.
+	return supervisorWaitPowerGood(SUPERVISOR_REPLY_ENPG_CMV);
 }
 
 int supervisorEnableSSDPower(void)
 {
-	u8 ssdPowerReady = 0x00;
-	u8 uart1Reply = 0x00;
-
 	supervisor_command_en |= SUPERVISOR_COMMAND_EN_3V3SSD;
 
-	while(!ssdPowerReady)
-	{
-	   	XUartPs_SendByte(uart1Config->BaseAddress, SUPERVISOR_PREFIX_COMMAND | supervisor_command_en);
-	   	usleep(10000);
-	   	uart1Reply = XUartPs_RecvByte(uart1Config->BaseAddress);
-	   	if((uart1Reply & SUPERVISOR_PREFIX_MASK) == SUPERVISOR_PREFIX_REPLY)
-	   	{
-	   		// Reply prefix is valid, check EN and PG flags.
-	   		if((uart1Reply & SUPERVISOR_REPLY_ENPG_SSD) == SUPERVISOR_REPLY_ENPG_SSD)
-	   		{
-	   			// EN_CMV, PG_3V9, and PG_VDD18 are all set. Okay to proceed.
-	   			ssdPowerReady = 0x01;
-	   		}
-	   	}
-	}
-
-	return SUPERVISOR_OK;
+	return supervisorWaitPowerGood(SUPERVISOR_REPLY_ENPG_SSD);
 }
 
 void supervisorSetFan(u8 fanSpeed)
@@ -154,13 +172,31 @@ void supervisorSetFan(u8 fanSpeed)
 		}
 	}
 
-	XUartPs_SendByte(uart1Config->BaseAddress, SUPERVISOR_PREFIX_COMMAND | supervisor_command_en);
+	supervisorFanSpeed = fanSpeed;
+	supervisorQueue(SUPERVISOR_REQUEST_COMMAND);
+}
+
+void supervisorRequestFan(u8 fanSpeed)
+{
+	supervisorFanRequest = fanSpeed;
 }
 
 void supervisorService(void)
 {
-	XUartPs_SendByte(uart1Config->BaseAddress, SUPERVISOR_PREFIX_BATTERY);
-	supervisorVBatt = XUartPs_RecvByte(uart1Config->BaseAddress);
+	u8 fanRequest;
+	XTime tNow;
+
+	fanRequest = __atomic_exchange_n(&supervisorFanRequest, SUPERVISOR_FAN_NONE, __ATOMIC_RELAXED);
+	if(fanRequest != SUPERVISOR_FAN_NONE) { supervisorSetFan(fanRequest); }
+
+	XTime_GetTime(&tNow);
+	if(((tNow - tSupervisorBattery) * US_PER_COUNT) >= SUPERVISOR_BATTERY_PERIOD_US)
+	{
+		tSupervisorBattery = tNow;
+		supervisorQueue(SUPERVISOR_REQUEST_BATTERY);
+	}
+
+	supervisorProcess();
 }
 
 u8 terminalGetKeypress(void)
@@ -176,3 +212,133 @@ u8 terminalGetKeypress(void)
 }
 
 // Private Function Definitions ----------------------------------------------------------------------------------------
+
+// Queue a request, unless one of the same type is already waiting. A command carries the whole EN state and is built
+// when it's sent, so a queued one already covers any later change.
+void supervisorQueue(u8 type)
+{
+	if(supervisorQueued & (1 << type)) { return; }
+	if(!ringPush(&supervisorRequestRing, &type)) { return; }
+	supervisorQueued |= (1 << type);
+
+	supervisorProcess();
+}
+
+// Match received bytes to the request in flight, expire it if the supervisor doesn't answer, and send the next one.
+// Never waits.
+void supervisorProcess(void)
+{
+	u8 rxByte;
+	u8 txByte;
+	u8 type;
+	XTime tNow;
+
+	while(ringPop(&supervisorRxRing, &rxByte))
+	{
+		if(supervisorActive == SUPERVISOR_REQUEST_COMMAND)
+		{
+			if((rxByte & SUPERVISOR_PREFIX_MASK) != SUPERVISOR_PREFIX_REPLY) { continue; }
+			supervisorReply = rxByte;
+			supervisorActive = SUPERVISOR_REQUEST_NONE;
+		}
+		else if(supervisorActive == SUPERVISOR_REQUEST_BATTERY)
+		{
+			supervisorVBatt = rxByte;
+			supervisorActive = SUPERVISOR_REQUEST_NONE;
+		}
+		// Anything else is a late reply to a request that already timed out.
+	}
+
+	XTime_GetTime(&tNow);
+	if((supervisorActive != SUPERVISOR_REQUEST_NONE)
+	&& (((tNow - tSupervisorSent) * US_PER_COUNT) >= SUPERVISOR_REPLY_TIMEOUT_US))
+	{
+		supervisorTimeouts++;
+		supervisorActive = SUPERVISOR_REQUEST_NONE;
+	}
+
+	if(supervisorActive != SUPERVISOR_REQUEST_NONE) { return; }
+	if(!ringPop(&supervisorRequestRing, &type)) { return; }
+	supervisorQueued &= ~(1 << type);
+	supervisorActive = type;
+
+	if(type == SUPERVISOR_REQUEST_COMMAND)
+	{
+		txByte = SUPERVISOR_PREFIX_COMMAND | supervisor_command_en;
+	}
+	else
+	{
+		txByte = SUPERVISOR_PREFIX_BATTERY;
+	}
+
+	tSupervisorSent = tNow;
+	ringPush(&supervisorTxRing, &txByte);
+	XUartPs_WriteReg(uart1Config->BaseAddress, XUARTPS_IER_OFFSET, XUARTPS_IXR_TXEMPTY);
+}
+
+// Move bytes without the ISR, for the power-up sequence. The UART interrupts are masked so this can't interleave
+// with isrSupervisorUart() if interrupts are already enabled.
+void supervisorPoll(void)
+{
+	XUartPs_WriteReg(uart1Config->BaseAddress, XUARTPS_IDR_OFFSET, XUARTPS_IXR_MASK);
+	supervisorUartTransfer();
+	XUartPs_WriteReg(uart1Config->BaseAddress, XUARTPS_IER_OFFSET, XUARTPS_IXR_RXOVR);
+	if(ringCount(&supervisorTxRing) > 0)
+	{
+		XUartPs_WriteReg(uart1Config->BaseAddress, XUARTPS_IER_OFFSET, XUARTPS_IXR_TXEMPTY);
+	}
+
+	supervisorProcess();
+}
+
+// Resend the command until the reply shows all of the requested EN and PG flags. Init only.
+int supervisorWaitPowerGood(u8 enpg)
+{
+	XTime tStart;
+	XTime tNow;
+
+	supervisorReply = 0x00;
+	XTime_GetTime(&tStart);
+	tNow = tStart;
+	do
+	{
+		// Re-send the command to poll power good, but leave the supervisor some time between requests.
+		if((supervisorActive == SUPERVISOR_REQUEST_NONE)
+		&& (((tNow - tSupervisorSent) * US_PER_COUNT) >= SUPERVISOR_POWER_RESEND_US))
+		{ supervisorQueue(SUPERVISOR_REQUEST_COMMAND); }
+		supervisorPoll();
+		if((supervisorReply & enpg) == enpg) { return SUPERVISOR_OK; }
+		XTime_GetTime(&tNow);
+	}
+	while(((tNow - tStart) * US_PER_COUNT) < SUPERVISOR_POWER_TIMEOUT_US);
+
+	return SUPERVISOR_ERROR;
+}
+
+// Drain the RX FIFO into the RX ring and fill the TX FIFO from the TX ring.
+void supervisorUartTransfer(void)
+{
+	u32 base = uart1Config->BaseAddress;
+	u8 byte;
+
+	XUartPs_WriteReg(base, XUARTPS_ISR_OFFSET, XUartPs_ReadReg(base, XUARTPS_ISR_OFFSET));
+
+	while(XUartPs_IsReceiveData(base))
+	{
+		byte = (u8) XUartPs_ReadReg(base, XUARTPS_FIFO_OFFSET);
+		ringPush(&supervisorRxRing, &byte);
+	}
+
+	while(!XUartPs_IsTransmitFull(base) && ringPop(&supervisorTxRing, &byte))
+	{
+		XUartPs_WriteReg(base, XUARTPS_FIFO_OFFSET, byte);
+	}
+
+	// Stop TX empty interrupts once the ring is drained. Re-check after masking: the main loop may have pushed a
+	// byte and unmasked in between.
+	if(ringCount(&supervisorTxRing) == 0)
+	{
+		XUartPs_WriteReg(base, XUARTPS_IDR_OFFSET, XUARTPS_IXR_TXEMPTY);
+		if(ringCount(&supervisorTxRing) > 0) { XUartPs_WriteReg(base, XUARTPS_IER_OFFSET, XUARTPS_IXR_TXEMPTY); }
+	}
+}
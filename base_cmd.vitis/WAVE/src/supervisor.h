@@ -37,21 +37,33 @@ THE SOFTWARE.
 #define SUPERVISOR_FAN_OFF 0
 #define SUPERVISOR_FAN_LOW 1
 #define SUPERVISOR_FAN_HIGH 2
+#define SUPERVISOR_FAN_NONE 0xFF
 
 // Public Type Definitions ---------------------------------------------------------------------------------------------
 
 // Public Function Prototypes ------------------------------------------------------------------------------------------
 
 void supervisorInit(void);
+
+// Power-up sequence. Resend the enable command until the supervisor reports power good, or time out. Init only.
 int supervisorEnableCMVPower(void);
 int supervisorEnableSSDPower(void);
+
 void supervisorSetFan(u8 fanSpeed);
+
+// Set the fan speed from the storage core. Applied on core 0 by the next supervisorService().
+void supervisorRequestFan(u8 fanSpeed);
+
+// Send queued requests and collect their replies. Never waits on the supervisor.
 void supervisorService(void);
+void isrSupervisorUart(void * CallbackRef);
 
 u8 terminalGetKeypress(void);
 
 // Externed Public Global Variables ------------------------------------------------------------------------------------
 
 extern u8 supervisorVBatt;
+extern u8 supervisorFanSpeed;
+extern u32 supervisorTimeouts;
 
 #endif
@@ -0,0 +1,334 @@
+/*
+WAVE Event Trace
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "trace.h"
+#include <string.h>
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define TRACE_CYCLES_PER_US		(XPAR_CPU_CORTEXA53_0_CPU_CLK_FREQ_HZ / 1000000)
+
+#define TRACE_NUM_SPANS			12
+#define TRACE_ARG_SLOTS			256			// Concurrent spans matched by arg, e.g. NVMe commands in flight.
+#define TRACE_HIST_BINS			24			// Power-of-two [us] bins, up to about 8s.
+#define TRACE_PATH_MAX			32			// Records printed for a worst-case path.
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+// A latency measured between two events. If the start and end events are the same, it's a period.
+typedef struct
+{
+	const char * strName;
+	u16 eventStart;
+	u16 eventEnd;
+	u8 matchArg;				// Pair start and end events by arg.
+} TraceSpan_s;
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+void traceAnalyzeSpan(const TraceSpan_s * span, u32 iFirst, u32 iLast);
+void tracePrintPath(u32 iStart, u32 iEnd, u16 core);
+const char * traceEventName(u16 event);
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+TraceRecord_s traceBuffer[TRACE_BUFFER_SIZE];
+OCM_DATA u32 traceIndex = 0;
+OCM_DATA u8 traceEnabled = 0;
+
+const TraceSpan_s traceSpan[TRACE_NUM_SPANS] =
+{
+	{"FOT period",        TRACE_FOT_ENTER,    TRACE_FOT_ENTER,         0},
+	{"FOT critical",      TRACE_FOT_ENTER,    TRACE_FOT_CRITICAL_EXIT, 0},
+	{"FOT ISR",           TRACE_FOT_ENTER,    TRACE_FOT_EXIT,          0},
+	{"FOT defer delay",   TRACE_FOT_EXIT,     TRACE_FOT_BH_ENTER,      0},
+	{"FOT deferred",      TRACE_FOT_BH_ENTER, TRACE_FOT_BH_EXIT,       0},
+	{"VSYNC ISR",         TRACE_VSYNC_ENTER,  TRACE_VSYNC_EXIT,        0},
+	{"IMU ISR",           TRACE_IMU_ENTER,    TRACE_IMU_EXIT,          0},
+	{"REC prep",          TRACE_REC_ENTER,    TRACE_REC_PREP,          0},
+	{"REC headers",       TRACE_REC_PREP,     TRACE_REC_HEADERS,       0},
+	{"REC codestreams",   TRACE_REC_HEADERS,  TRACE_REC_EXIT,          0},
+	{"REC total",         TRACE_REC_ENTER,    TRACE_REC_EXIT,          0},
+	{"NVMe command",      TRACE_NVME_SUBMIT,  TRACE_NVME_COMPLETE,     1}
+};
+
+// Span analysis working state.
+u64 traceSpanStart[TRACE_ARG_SLOTS];
+u32 traceSpanStartIndex[TRACE_ARG_SLOTS];
+u8 traceSpanStarted[TRACE_ARG_SLOTS];
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void traceInit(void)
+{
+	traceInitCore();
+
+	traceIndex = 0;
+	traceEnabled = 1;
+}
+
+void traceInitCore(void)
+{
+	u64 pmcr;
+
+	// Enable and reset the cycle counter.
+	asm volatile("mrs %0, pmcr_el0" : "=r" (pmcr));
+	pmcr |= 0x05;
+	asm volatile("msr pmcr_el0, %0" : : "r" (pmcr));
+	asm volatile("msr pmcntenset_el0, %0" : : "r" ((u64)0x80000000));
+	asm volatile("isb");
+}
+
+OCM_TEXT void traceEvent(u16 event, u32 arg)
+{
+	u64 daif;
+	u64 mpidr;
+	u32 i;
+	u64 tCycles;
+
+	if(!traceEnabled) { return; }
+
+	// Claim a slot and timestamp it with IRQs masked, so each core's records are in time order. The claim
+	// itself is atomic, since the storage core traces too.
+	asm volatile("mrs %0, daif" : "=r" (daif));
+	asm volatile("msr daifset, #2");
+	i = __atomic_fetch_add(&traceIndex, 1, __ATOMIC_RELAXED);
+	tCycles = traceGetCycles();
+	asm volatile("msr daif, %0" : : "r" (daif));
+	asm volatile("mrs %0, mpidr_el1" : "=r" (mpidr));
+
+	traceBuffer[i % TRACE_BUFFER_SIZE].tCycles = tCycles;
+	traceBuffer[i % TRACE_BUFFER_SIZE].event = event;
+	traceBuffer[i % TRACE_BUFFER_SIZE].core = (u16)(mpidr & 0xFF);
+	traceBuffer[i % TRACE_BUFFER_SIZE].arg = arg;
+}
+
+OCM_TEXT u64 traceGetCycles(void)
+{
+	u64 tCycles;
+	asm volatile("mrs %0, pmccntr_el0" : "=r" (tCycles));
+	return tCycles;
+}
+
+void traceDump(u8 includeRecords)
+{
+	char strResult[128];
+	u32 nRecords, iFirst, iLast;
+	TraceRecord_s * record;
+
+	traceEnabled = 0;
+
+	iLast = traceIndex;
+	nRecords = (iLast < TRACE_BUFFER_SIZE) ? iLast : TRACE_BUFFER_SIZE;
+	iFirst = iLast - nRecords;
+
+	sprintf(strResult, "Trace: %u records, %u cycles/us.\r\n", nRecords, TRACE_CYCLES_PER_US);
+	xil_printf(strResult);
+
+	for(int s = 0; s < TRACE_NUM_SPANS; s++)
+	{
+		traceAnalyzeSpan(&traceSpan[s], iFirst, iLast);
+	}
+
+	if(includeRecords)
+	{
+		xil_printf("core,cycles,event,arg\r\n");
+		for(u32 i = iFirst; i != iLast; i++)
+		{
+			record = &traceBuffer[i % TRACE_BUFFER_SIZE];
+			sprintf(strResult, "%u,%llu,%s,%u\r\n", record->core, record->tCycles, traceEventName(record->event),
+			        record->arg);
+			xil_printf(strResult);
+		}
+	}
+
+	traceEnabled = 1;
+}
+
+u32 traceExport(u8 * buffer, u32 size)
+{
+	TraceExportHeader_s * header = (TraceExportHeader_s *) buffer;
+	TraceRecord_s * record = (TraceRecord_s *) (buffer + sizeof(TraceExportHeader_s));
+	u32 nRecords, iFirst, iLast;
+
+	if(size < sizeof(TraceExportHeader_s)) { return 0; }
+
+	traceEnabled = 0;
+
+	iLast = traceIndex;
+	nRecords = (iLast < TRACE_BUFFER_SIZE) ? iLast : TRACE_BUFFER_SIZE;
+	if(nRecords > (size - sizeof(TraceExportHeader_s)) / sizeof(TraceRecord_s))
+	{ nRecords = (size - sizeof(TraceExportHeader_s)) / sizeof(TraceRecord_s); }
+	iFirst = iLast - nRecords;
+
+	memcpy(header->strMagic, "TRCE", 4);
+	header->version = TRACE_EXPORT_VERSION;
+	header->recordSize = sizeof(TraceRecord_s);
+	header->nRecords = nRecords;
+	header->cyclesPerUs = TRACE_CYCLES_PER_US;
+
+	for(u32 i = iFirst; i != iLast; i++)
+	{
+		memcpy(&record[i - iFirst], &traceBuffer[i % TRACE_BUFFER_SIZE], sizeof(TraceRecord_s));
+	}
+
+	traceEnabled = 1;
+
+	return sizeof(TraceExportHeader_s) + nRecords * sizeof(TraceRecord_s);
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+void traceAnalyzeSpan(const TraceSpan_s * span, u32 iFirst, u32 iLast)
+{
+	char strResult[128];
+	u32 hist[TRACE_HIST_BINS];
+	u32 nSpans = 0;
+	u64 tSum = 0;
+	u64 tMax = 0;
+	u32 iMaxStart = 0, iMaxEnd = 0;
+	u32 slot, iBin;
+	u64 t, t_us;
+	u16 core = 0xFFFF;
+	TraceRecord_s * record;
+
+	memset(hist, 0, sizeof(hist));
+	memset(traceSpanStarted, 0, sizeof(traceSpanStarted));
+
+	for(u32 i = iFirst; i != iLast; i++)
+	{
+		record = &traceBuffer[i % TRACE_BUFFER_SIZE];
+
+		// A span is measured on the core that first records its start event.
+		if((core == 0xFFFF) && (record->event == span->eventStart)) { core = record->core; }
+		if(record->core != core) { continue; }
+
+		slot = span->matchArg ? (record->arg % TRACE_ARG_SLOTS) : 0;
+
+		// End before start, so a period span closes and reopens on the same event.
+		if((record->event == span->eventEnd) && traceSpanStarted[slot])
+		{
+			t = record->tCycles - traceSpanStart[slot];
+			t_us = t / TRACE_CYCLES_PER_US;
+			iBin = 0;
+			while((iBin < (TRACE_HIST_BINS - 1)) && ((1ull << iBin) <= t_us)) { iBin++; }
+			hist[iBin]++;
+			nSpans++;
+			tSum += t;
+			if(t > tMax)
+			{
+				tMax = t;
+				iMaxStart = traceSpanStartIndex[slot];
+				iMaxEnd = i;
+			}
+			traceSpanStarted[slot] = 0;
+		}
+
+		if(record->event == span->eventStart)
+		{
+			traceSpanStart[slot] = record->tCycles;
+			traceSpanStartIndex[slot] = i;
+			traceSpanStarted[slot] = 1;
+		}
+	}
+
+	if(nSpans == 0) { return; }
+
+	sprintf(strResult, "%s: n = %u, mean = %llu us, max = %llu us\r\n", span->strName, nSpans,
+	        tSum / nSpans / TRACE_CYCLES_PER_US, tMax / TRACE_CYCLES_PER_US);
+	xil_printf(strResult);
+
+	for(iBin = 0; iBin < TRACE_HIST_BINS; iBin++)
+	{
+		if(hist[iBin] == 0) { continue; }
+		if(iBin < (TRACE_HIST_BINS - 1))
+		{ sprintf(strResult, "  < %8llu us: %u\r\n", (1ull << iBin), hist[iBin]); }
+		else
+		{ sprintf(strResult, "  >=%8llu us: %u\r\n", (1ull << (iBin - 1)), hist[iBin]); }
+		xil_printf(strResult);
+	}
+
+	xil_printf("  Worst case:\r\n");
+	tracePrintPath(iMaxStart, iMaxEnd, core);
+}
+
+// Print one core's records from the start to the end of a span, relative to its start.
+void tracePrintPath(u32 iStart, u32 iEnd, u16 core)
+{
+	char strResult[128];
+	TraceRecord_s * record;
+	u64 tStart = traceBuffer[iStart % TRACE_BUFFER_SIZE].tCycles;
+	u32 n = 0;
+
+	for(u32 i = iStart; ; i++)
+	{
+		if(n == TRACE_PATH_MAX)
+		{
+			// Skip to the end of the span.
+			sprintf(strResult, "    ... %u records ...\r\n", iEnd - i);
+			xil_printf(strResult);
+			i = iEnd;
+		}
+
+		record = &traceBuffer[i % TRACE_BUFFER_SIZE];
+		if((record->core != core) && (i != iEnd)) { continue; }
+		sprintf(strResult, "    +%8llu us %s %u\r\n", (record->tCycles - tStart) / TRACE_CYCLES_PER_US,
+		        traceEventName(record->event), record->arg);
+		xil_printf(strResult);
+		n++;
+
+		if(i == iEnd) { break; }
+	}
+}
+
+const char * traceEventName(u16 event)
+{
+	switch(event)
+	{
+	case TRACE_FOT_ENTER: return "FOT_ENTER";
+	case TRACE_FOT_CRITICAL_EXIT: return "FOT_CRITICAL_EXIT";
+	case TRACE_FOT_EXIT: return "FOT_EXIT";
+	case TRACE_VSYNC_ENTER: return "VSYNC_ENTER";
+	case TRACE_VSYNC_EXIT: return "VSYNC_EXIT";
+	case TRACE_IMU_ENTER: return "IMU_ENTER";
+	case TRACE_IMU_EXIT: return "IMU_EXIT";
+	case TRACE_FOT_BH_ENTER: return "FOT_BH_ENTER";
+	case TRACE_FOT_BH_EXIT: return "FOT_BH_EXIT";
+	case TRACE_REC_ENTER: return "REC_ENTER";
+	case TRACE_REC_PREP: return "REC_PREP";
+	case TRACE_REC_HEADERS: return "REC_HEADERS";
+	case TRACE_REC_EXIT: return "REC_EXIT";
+	case TRACE_NVME_SUBMIT: return "NVME_SUBMIT";
+	case TRACE_NVME_COMPLETE: return "NVME_COMPLETE";
+	case TRACE_SERVICE: return "SERVICE";
+	default: return "UNKNOWN";
+	}
+}
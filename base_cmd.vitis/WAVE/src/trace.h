@@ -0,0 +1,101 @@
+/*
+WAVE Event Trace Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __TRACE_INCLUDE__
+#define __TRACE_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+#define TRACE_BUFFER_SIZE		4096		// Records. 64KiB, in cached program memory.
+#define TRACE_EXPORT_VERSION	1
+
+// Trace Events
+#define TRACE_FOT_ENTER			0x01
+#define TRACE_FOT_CRITICAL_EXIT	0x02	// Time-critical encoder access done.
+#define TRACE_FOT_EXIT			0x03
+#define TRACE_VSYNC_ENTER		0x04
+#define TRACE_VSYNC_EXIT		0x05
+#define TRACE_IMU_ENTER			0x06
+#define TRACE_IMU_EXIT			0x07
+#define TRACE_FOT_BH_ENTER		0x08	// arg: FOT snapshots pending
+#define TRACE_FOT_BH_EXIT		0x09
+#define TRACE_REC_ENTER			0x10	// arg: nFramesOut
+#define TRACE_REC_PREP			0x11	// Headers filled in and checksummed. arg: nGroup
+#define TRACE_REC_HEADERS		0x12	// Frame headers written.
+#define TRACE_REC_EXIT			0x13
+#define TRACE_NVME_SUBMIT		0x20	// arg: CID
+#define TRACE_NVME_COMPLETE		0x21	// arg: CID
+#define TRACE_SERVICE			0x31	// arg: scheduler task index. Repeat runs of the same task are traced once.
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+// 16B with no padding, so the export carries it as-is.
+typedef struct
+{
+	u64 tCycles;				// A53 cycle counter (PMCCNTR_EL0).
+	u16 event;					// Trace Event
+	u16 core;					// Cycle counts are only comparable between records from the same core.
+	u32 arg;
+} TraceRecord_s;
+
+// Export format, for reading over USB. Little-endian, the header followed by nRecords records, oldest first.
+typedef struct __attribute__((packed))
+{
+	char strMagic[4];			// "TRCE"
+	u16 version;
+	u16 recordSize;				// sizeof(TraceRecord_s)
+	u32 nRecords;
+	u32 cyclesPerUs;
+} TraceExportHeader_s;
+
+#define TRACE_EXPORT_SIZE_MAX	(sizeof(TraceExportHeader_s) + TRACE_BUFFER_SIZE * sizeof(TraceRecord_s))
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+void traceInit(void);
+
+// Start the cycle counter on the calling core. traceInit() does this for core 0.
+void traceInitCore(void);
+
+// Record an event. Safe to call from ISRs, the main loop, and the storage core.
+void traceEvent(u16 event, u32 arg);
+
+// Read the A53 cycle counter.
+u64 traceGetCycles(void);
+
+// Print latency histograms and worst-case paths over UART, optionally followed by the raw records as CSV.
+// Tracing is paused during the dump. Blocks for as long as the UART takes.
+void traceDump(u8 includeRecords);
+
+// Write the trace to a buffer in the export format, oldest record first, keeping the newest records that fit. Tracing
+// is paused during the copy. Returns the number of bytes written.
+u32 traceExport(u8 * buffer, u32 size);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+#endif
@@ -32,6 +32,12 @@ THE SOFTWARE.
 #include "fs.h"
 #include "frame.h"
 #include "supervisor.h"
+#include "verify.h"
+#include "trace.h"
+#include "irq.h"
+#include "storage.h"
+#include "perf.h"
+#include "log.h"
 
 // Private Pre-Processor Definitions -----------------------------------------------------------------------------------
 
@@ -184,6 +190,7 @@ void uiInit(void)
 void uiService(void)
 {
 	char strWorking[32];
+	u32 tRecord;
 
 	// Temporary terminal service. To be replaced with QX protocol?
 	// ---------------------------------------------------------------------------------------------
@@ -199,7 +206,7 @@ void uiService(void)
 			u32 offsetBot = cmvGetOffsets() & 0xFFFF;
 			offsetBot++;
 			cmvSetOffsets(offsetBot, offsetBot);
-			xil_printf("CMV offsets set to %d.\r\n", offsetBot);
+			LOG_INFO("CMV offsets set to %d.\r\n", offsetBot);
 			break;
 		}
 		case 's':
@@ -208,7 +215,7 @@ void uiService(void)
 			u32 offsetBot = cmvGetOffsets() & 0xFFFF;
 			offsetBot--;
 			cmvSetOffsets(offsetBot, offsetBot);
-			xil_printf("CMV offsets set to %d.\r\n", offsetBot);
+			LOG_INFO("CMV offsets set to %d.\r\n", offsetBot);
 			break;
 		}
 		default:
@@ -226,7 +233,7 @@ void uiService(void)
 			u8 Vtfl3 = (cmvGetVtfl() >> 7) & 0x7F;
 			Vtfl2++;
 			cmvSetVtfl(Vtfl2, Vtfl3);
-			xil_printf("CMV HDR kneepoints set to %d (Vtfl2) and %d (Vtfl3).\r\n", Vtfl2, Vtfl3);
+			LOG_INFO("CMV HDR kneepoints set to %d (Vtfl2) and %d (Vtfl3).\r\n", Vtfl2, Vtfl3);
 			break;
 		}
 		case 's':
@@ -236,7 +243,7 @@ void uiService(void)
 			u8 Vtfl3 = (cmvGetVtfl() >> 7) & 0x7F;
 			Vtfl2--;
 			cmvSetVtfl(Vtfl2, Vtfl3);
-			xil_printf("CMV HDR kneepoints set to %d (Vtfl2) and %d (Vtfl3).\r\n", Vtfl2, Vtfl3);
+			LOG_INFO("CMV HDR kneepoints set to %d (Vtfl2) and %d (Vtfl3).\r\n", Vtfl2, Vtfl3);
 			break;
 		}
 		default:
@@ -254,7 +261,7 @@ void uiService(void)
 			u8 Vtfl3 = (cmvGetVtfl() >> 7) & 0x7F;
 			Vtfl3++;
 			cmvSetVtfl(Vtfl2, Vtfl3);
-			xil_printf("CMV HDR kneepoints set to %d (Vtfl2) and %d (Vtfl3).\r\n", Vtfl2, Vtfl3);
+			LOG_INFO("CMV HDR kneepoints set to %d (Vtfl2) and %d (Vtfl3).\r\n", Vtfl2, Vtfl3);
 			break;
 		}
 		case 's':
@@ -264,7 +271,7 @@ void uiService(void)
 			u8 Vtfl3 = (cmvGetVtfl() >> 7) & 0x7F;
 			Vtfl3--;
 			cmvSetVtfl(Vtfl2, Vtfl3);
-			xil_printf("CMV HDR kneepoints set to %d (Vtfl2) and %d (Vtfl3).\r\n", Vtfl2, Vtfl3);
+			LOG_INFO("CMV HDR kneepoints set to %d (Vtfl2) and %d (Vtfl3).\r\n", Vtfl2, Vtfl3);
 			break;
 		}
 		default:
@@ -272,8 +279,46 @@ void uiService(void)
 		}
 		break;
 	default:
+	{
+		// Event trace dump: summary only (t) or with raw records (T). Interrupt (i) and scheduler (s) statistics.
+		// Performance counters (p), and start a new counter window (P). Cycle the log level (l).
+		// Reports print synchronously, so waiting log messages go out first rather than interleaving with them.
+		u8 keypress = terminalGetKeypress();
+		if(keypress != 0x00) { logFlush(); }
+
+		switch(keypress)
+		{
+		case 'l':
+			logLevel = (logLevel + 1) % (LOG_LEVEL_DEBUG + 1);
+			xil_printf("Log level set to %d.\r\n", logLevel);
+			break;
+		case 'p':
+			perfPrint();
+			break;
+		case 'P':
+			perfPrint();
+			perfResetAll();
+			xil_printf("Performance counters reset.\r\n");
+			break;
+		case 's':
+			schedPrintStats(&mainSched);
+			schedPrintStats(&storageSched);
+			break;
+		case 'i':
+			irqPrintStats();
+			break;
+		case 't':
+			traceDump(0);
+			break;
+		case 'T':
+			traceDump(1);
+			break;
+		default:
+			break;
+		}
 		break;
 	}
+	}
 	// ---------------------------------------------------------------------------------------------
 
 	// Menu state machine.
@@ -470,6 +515,34 @@ uiServiceComplete:
 	sprintf(strWorking, "%4d/%-4d GB", fsFreeGB, fsSizeGB);
 	uiDrawStringColRow(UI_ID_BOT, strWorking, 20, 0);
 
+	// Clip is still being written to the SSD after REC was stopped.
+	if(frameRecState == FRAME_REC_STATE_FINALIZE)
+	{ sprintf(strWorking, "FIN%5u", frameGetBacklog()); }
+	// High-pass codestreams are being skipped to keep up with capture.
+	else if((frameRecState == FRAME_REC_STATE_CONTINUE) && frameCSSkipFlags)
+	{ sprintf(strWorking, "HF DROP "); }
+	// While choosing a frame rate, show how long it can be recorded before data is dropped.
+	else if(popMenuActive == CSETTING_FPS)
+	{
+		tRecord = cStateGetRecordTime();
+		if(tRecord == CSTATE_RECORD_TIME_SUSTAINABLE) { sprintf(strWorking, "SUSTAIN "); }
+		// No saved benchmark for this SSD yet. Run one from the FORMAT menu.
+		else if(tRecord == CSTATE_RECORD_TIME_UNKNOWN) { sprintf(strWorking, "DROP  ? "); }
+		else if(tRecord < 1000) { sprintf(strWorking, "DROP%3us", (unsigned int) tRecord); }
+		else if(tRecord < 60000) { sprintf(strWorking, "DROP%3um", (unsigned int)(tRecord / 60)); }
+		else { sprintf(strWorking, "DROP999m"); }
+	}
+	// Read-back verification of the last clip.
+	else if(verifyState == VERIFY_STATE_RUNNING)
+	{ sprintf(strWorking, "VFY%5u", nFramesVerified % 100000); }
+	else if(verifyState == VERIFY_STATE_PASS)
+	{ sprintf(strWorking, "VFY PASS"); }
+	else if(verifyState == VERIFY_STATE_FAIL)
+	{ sprintf(strWorking, "VFY FAIL"); }
+	else
+	{ sprintf(strWorking, "        "); }
+	uiDrawStringColRow(UI_ID_BOT, strWorking, 33, 0);
+
 	if((uiServiceCounter % 384) < 128)
 	{ sprintf(strWorking, "CPU:%3.0f*C", psplGetTemp(psTemp)); }
 	else if((uiServiceCounter % 384) < 256)
@@ -0,0 +1,211 @@
+/*
+WAVE Clip Read-Back Verifier
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "verify.h"
+#include "frame.h"
+#include "fs.h"
+#include "memory_map.h"
+#include "log.h"
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define VERIFY_STEP_OPEN		0x00
+#define VERIFY_STEP_HEADER		0x01
+#define VERIFY_STEP_CS			0x02
+
+#define VERIFY_GROUP_MAX		(MEM_MAP_VERIFY_HEADER_SIZE / sizeof(FrameHeader_s))
+#define VERIFY_CS_BUFFER_SIZE	MEM_MAP_VERIFY_CS_SIZE
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+void verifyStepOpen(void);
+void verifyStepHeader(void);
+void verifyStepCS(void);
+void verifyFinish(u8 state);
+
+// Public Global Variables ---------------------------------------------------------------------------------------------
+
+u8 verifyState = VERIFY_STATE_NONE;
+int nClipVerify = -1;
+u32 nFramesVerified = 0;
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+// Read-back buffers in external DDR4 RAM.
+FrameHeader_s * vfyHeaderBuffer = (FrameHeader_s *)(MEM_MAP_VERIFY_HEADER_BASE);	// Up to VERIFY_GROUP_MAX headers.
+u8 * vfyCSBuffer = (u8 *)(MEM_MAP_VERIFY_CS_BASE);								// One codestream for a frame group.
+
+u8 vfyStep = VERIFY_STEP_OPEN;
+int nFileVerify = 0;
+u32 nGroupVerify = 0;
+u32 iCSVerify = 0;
+s64 nFrameExpected = -1;
+
+// Interrupt Handlers --------------------------------------------------------------------------------------------------
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void verifyStartClip(int n)
+{
+	fsCloseVerifyFile();
+
+	nClipVerify = n;
+	nFileVerify = 0;
+	nFramesVerified = 0;
+	nFrameExpected = -1;
+	vfyStep = VERIFY_STEP_OPEN;
+	verifyState = VERIFY_STATE_RUNNING;
+}
+
+void verifyService(void)
+{
+	if(verifyState != VERIFY_STATE_RUNNING) { return; }
+
+	switch(vfyStep)
+	{
+	case VERIFY_STEP_OPEN:
+		verifyStepOpen();
+		break;
+	case VERIFY_STEP_HEADER:
+		verifyStepHeader();
+		break;
+	case VERIFY_STEP_CS:
+		verifyStepCS();
+		break;
+	default:
+		verifyFinish(VERIFY_STATE_FAIL);
+		break;
+	}
+}
+
+void verifyReset(void)
+{
+	fsCloseVerifyFile();
+
+	nClipVerify = -1;
+	nFramesVerified = 0;
+	vfyStep = VERIFY_STEP_OPEN;
+	verifyState = VERIFY_STATE_NONE;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+void verifyStepOpen(void)
+{
+	if(fsOpenVerifyFile(nClipVerify, nFileVerify))
+	{
+		vfyStep = VERIFY_STEP_HEADER;
+	}
+	else
+	{
+		// Running out of files is the normal end of a clip, but a clip needs at least one frame.
+		if(nFramesVerified > 0) { verifyFinish(VERIFY_STATE_PASS); }
+		else { verifyFinish(VERIFY_STATE_FAIL); }
+	}
+}
+
+void verifyStepHeader(void)
+{
+	u32 nBytes;
+
+	// End of file on a frame boundary moves on to the next file.
+	nBytes = fsReadVerifyFile((u64) vfyHeaderBuffer, 512);
+	if(nBytes == 0)
+	{
+		fsCloseVerifyFile();
+		nFileVerify++;
+		vfyStep = VERIFY_STEP_OPEN;
+		return;
+	}
+	if(nBytes != 512) { verifyFinish(VERIFY_STATE_FAIL); return; }
+
+	// Files written before frame grouping have no group size.
+	nGroupVerify = vfyHeaderBuffer[0].nFramesGrouped;
+	if(nGroupVerify == 0) { nGroupVerify = 1; }
+	if(nGroupVerify > VERIFY_GROUP_MAX) { verifyFinish(VERIFY_STATE_FAIL); return; }
+
+	// Remaining headers in the group.
+	if(nGroupVerify > 1)
+	{
+		nBytes = fsReadVerifyFile((u64) &vfyHeaderBuffer[1], 512 * (nGroupVerify - 1));
+		if(nBytes != 512 * (nGroupVerify - 1)) { verifyFinish(VERIFY_STATE_FAIL); return; }
+	}
+
+	for(u32 n = 0; n < nGroupVerify; n++)
+	{
+		if(memcmp(vfyHeaderBuffer[n].strDelimiter, "WAVE HELLO!\n", 12) != 0) { verifyFinish(VERIFY_STATE_FAIL); return; }
+		if((nGroupVerify > 1) && (vfyHeaderBuffer[n].iFrameGrouped != n)) { verifyFinish(VERIFY_STATE_FAIL); return; }
+
+		// Frame numbers must be consecutive across the whole clip.
+		if((nFrameExpected >= 0) && (vfyHeaderBuffer[n].nFrame != (u32) nFrameExpected)) { verifyFinish(VERIFY_STATE_FAIL); return; }
+		nFrameExpected = (s64) vfyHeaderBuffer[n].nFrame + 1;
+
+		// Frames merged by a FOT overrun can't be decoded on their own, so the clip isn't frame-accurate.
+		if(vfyHeaderBuffer[n].nFramesLost != 0) { verifyFinish(VERIFY_STATE_FAIL); return; }
+	}
+
+	iCSVerify = 0;
+	vfyStep = VERIFY_STEP_CS;
+}
+
+void verifyStepCS(void)
+{
+	u32 szGroup, nBytes;
+	u32 offset;
+
+	szGroup = 0;
+	for(u32 n = 0; n < nGroupVerify; n++) { szGroup += vfyHeaderBuffer[n].csSize[iCSVerify]; }
+	if(szGroup > VERIFY_CS_BUFFER_SIZE) { verifyFinish(VERIFY_STATE_FAIL); return; }
+
+	nBytes = fsReadVerifyFile((u64) vfyCSBuffer, szGroup);
+	if(nBytes != szGroup) { verifyFinish(VERIFY_STATE_FAIL); return; }
+
+	// Check each frame's part of the codestream against its header checksum.
+	offset = 0;
+	for(u32 n = 0; n < nGroupVerify; n++)
+	{
+		if(frameCRC32C((u64)(vfyCSBuffer + offset), vfyHeaderBuffer[n].csSize[iCSVerify]) != vfyHeaderBuffer[n].csCRC32C[iCSVerify])
+		{ verifyFinish(VERIFY_STATE_FAIL); return; }
+		offset += vfyHeaderBuffer[n].csSize[iCSVerify];
+	}
+
+	iCSVerify++;
+	if(iCSVerify == 16)
+	{
+		nFramesVerified += nGroupVerify;
+		vfyStep = VERIFY_STEP_HEADER;
+	}
+}
+
+void verifyFinish(u8 state)
+{
+	fsCloseVerifyFile();
+	verifyState = state;
+	if(state == VERIFY_STATE_PASS) { LOG_INFO("Clip verified: %d frames.\r\n", nFramesVerified); }
+	else { LOG_WARNING("Warning: Clip verification failed after %d frames.\r\n", nFramesVerified); }
+}
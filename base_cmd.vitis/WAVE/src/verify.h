@@ -0,0 +1,58 @@
+/*
+WAVE Clip Read-Back Verifier Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef __VERIFY_INCLUDE__
+#define __VERIFY_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+#define VERIFY_STATE_NONE		0x00
+#define VERIFY_STATE_RUNNING	0x01
+#define VERIFY_STATE_PASS		0x02
+#define VERIFY_STATE_FAIL		0x03
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+// Queue a finalized clip for read-back verification. Replaces any verification in progress.
+void verifyStartClip(int n);
+
+// Verify the next step (one frame header group or one codestream group). Call only while not recording.
+void verifyService(void);
+
+// Abandon any verification, e.g. when the file system is formatted.
+void verifyReset(void);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+extern u8 verifyState;
+extern int nClipVerify;
+extern u32 nFramesVerified;
+
+#endif
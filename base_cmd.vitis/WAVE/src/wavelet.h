@@ -31,6 +31,11 @@ THE SOFTWARE.
 
 // Public Pre-Processor Definitions ------------------------------------------------------------------------------------
 
+// Decomposition levels in the recorded codestreams. Wavelet_S3 exists in the PL, but the encoder has
+// no XX3 inputs yet, so recording still stops at stage 2. tools/dwt26.c models stage 3 on the host, and
+// tools/wavelet_gain estimates its saving on an LL2 plane.
+#define WAVELET_NUM_STAGES 2
+
 // Public Type Definitions ---------------------------------------------------------------------------------------------
 
 // Public Function Prototypes ------------------------------------------------------------------------------------------
@@ -52,6 +52,7 @@
 #include "xparameters.h"		/* XPAR parameters */
 #include "xusb_ch9_storage.h"
 #include "xusb_class_storage.h"
+#include "log.h"
 
 /************************** Constant Definitions *****************************/
 
@@ -579,14 +580,14 @@ s32 Usb_SetConfigurationApp(struct Usb_DevData *InstancePtr,
 		RetVal = EpEnable(InstancePtr->PrivateData, 1, USB_EP_DIR_IN,
 				MaxPktSize, USB_EP_TYPE_BULK);
 		if (RetVal != XST_SUCCESS) {
-			xil_printf("failed to enable BULK IN Ep\r\n");
+			LOG_ERROR("failed to enable BULK IN Ep\r\n");
 			return XST_FAILURE;
 		}
 
 		RetVal = EpEnable(InstancePtr->PrivateData, 1, USB_EP_DIR_OUT,
 				MaxPktSize, USB_EP_TYPE_BULK);
 		if (RetVal != XST_SUCCESS) {
-			xil_printf("failed to enable BULK OUT Ep\r\n");
+			LOG_ERROR("failed to enable BULK OUT Ep\r\n");
 			return XST_FAILURE;
 		}
 
@@ -608,13 +609,13 @@ s32 Usb_SetConfigurationApp(struct Usb_DevData *InstancePtr,
 		/* Endpoint disables - not needed for Control EP */
 		RetVal = EpDisable(InstancePtr->PrivateData, 1, USB_EP_DIR_IN);
 		if (RetVal != XST_SUCCESS) {
-			xil_printf("failed to disable BULK IN Ep\r\n");
+			LOG_ERROR("failed to disable BULK IN Ep\r\n");
 			return XST_FAILURE;
 		}
 
 		RetVal = EpDisable(InstancePtr->PrivateData, 1, USB_EP_DIR_OUT);
 		if (RetVal != XST_SUCCESS) {
-			xil_printf("failed to disable BULK OUT Ep\r\n");
+			LOG_ERROR("failed to disable BULK OUT Ep\r\n");
 			return XST_FAILURE;
 		}
 
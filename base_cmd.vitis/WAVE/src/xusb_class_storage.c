@@ -55,6 +55,9 @@
 #include "xparameters.h"
 #include "xusb_ch9_storage.h"
 #include "nvme.h"
+#include "perf.h"
+#include "trace.h"
+#include "log.h"
 
 /************************** Constant Definitions *****************************/
 
@@ -128,6 +131,20 @@ static u8 txBuffer[128];
 static u8 txBuffer[128] ALIGNMENT_CACHELINE;
 #endif
 
+/* Export buffer for the WAVE performance counter read. */
+#ifdef __ICCARM__
+static u8 perfBuffer[2048];
+#else
+static u8 perfBuffer[2048] ALIGNMENT_CACHELINE;
+#endif
+
+/* Export buffer for the WAVE event trace read. */
+#ifdef __ICCARM__
+static u8 traceExportBuffer[TRACE_EXPORT_SIZE_MAX];
+#else
+static u8 traceExportBuffer[TRACE_EXPORT_SIZE_MAX] ALIGNMENT_CACHELINE;
+#endif
+
 /*****************************************************************************/
 /**
 * This function is class handler for Mass storage and is called when
@@ -259,7 +276,7 @@ void ParseCBW(struct Usb_DevData *InstancePtr)
 		u32 RetVal = EpBufferSend(InstancePtr->PrivateData, 1, (u8 *)((u64) SSD2USB_BUFFER_ADDR), rLength);
 
 		if (RetVal != XST_SUCCESS) {
-			xil_printf("Failed: READ LB Offset 0x%08x\n", lbOffset);
+			LOG_ERROR("Failed: READ LB Offset 0x%08x\r\n", lbOffset);
 			return;
 		}
 		break;
@@ -351,6 +368,39 @@ void ParseCBW(struct Usb_DevData *InstancePtr)
 		// ----------------------------------------------------------------------------
 		SendCSW(InstancePtr, 0);
 		break;
+
+	case USB_WAVE_READ_PERF:
+	{
+#ifdef CLASS_STORAGE_DEBUG
+		printf("SCSI: WAVE READ PERF\r\n");
+#endif
+		// Performance counter snapshot, in the PerfExport format.
+		// ----------------------------------------------------------------------------
+		u32 pLength = perfExport(perfBuffer, sizeof(perfBuffer));
+		if(pLength > CBW.dCBWDataTransferLength) { pLength = CBW.dCBWDataTransferLength; }
+		if(CBW.CBWCB[1] & 0x01) { perfResetAll(); }
+		// ----------------------------------------------------------------------------
+
+		Phase = USB_EP_STATE_DATA_IN;
+		EpBufferSend(InstancePtr->PrivateData, 1, perfBuffer, pLength);
+		break;
+	}
+
+	case USB_WAVE_READ_TRACE:
+	{
+#ifdef CLASS_STORAGE_DEBUG
+		printf("SCSI: WAVE READ TRACE\r\n");
+#endif
+		// Event trace snapshot, in the TraceExport format. Decode with tools/trace_decode.
+		// ----------------------------------------------------------------------------
+		u32 tLength = traceExport(traceExportBuffer, sizeof(traceExportBuffer));
+		if(tLength > CBW.dCBWDataTransferLength) { tLength = CBW.dCBWDataTransferLength; }
+		// ----------------------------------------------------------------------------
+
+		Phase = USB_EP_STATE_DATA_IN;
+		EpBufferSend(InstancePtr->PrivateData, 1, traceExportBuffer, tLength);
+		break;
+	}
 	}
 }
 
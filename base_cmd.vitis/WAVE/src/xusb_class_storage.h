@@ -55,6 +55,7 @@ extern "C" {
 /***************************** Include Files *********************************/
 #include "xil_types.h"
 #include "xusb_ch9.h"
+#include "memory_map.h"
 
 /************************** Constant Definitions *****************************/
 /*
@@ -75,11 +76,15 @@ extern "C" {
 #define USB_RBC_VERIFY				0x2f
 #define USB_SYNC_SCSI				0x35
 
+// WAVE vendor-specific opcodes.
+#define USB_WAVE_READ_PERF			0xC1	// CDB[1] bit 0: start a new counter window after the read.
+#define USB_WAVE_READ_TRACE			0xC2	// Event trace records, in the TraceExport format.
+
 #define VFLASH_BLOCK_SIZE	0x200
 
 // NVME bridge buffer space.
-#define SSD2USB_BUFFER_ADDR 0x70000000
-#define USB2SSD_BUFFER_ADDR 0x78000000
+#define SSD2USB_BUFFER_ADDR MEM_MAP_SSD2USB_BASE
+#define USB2SSD_BUFFER_ADDR MEM_MAP_USB2SSD_BASE
 
 /* Class request opcodes.
  */
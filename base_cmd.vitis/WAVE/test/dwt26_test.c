@@ -0,0 +1,149 @@
+/*
+WAVE 2/6 DWT Host Reference Test
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Checks the stage 3 host reference (tools/dwt26.c) against a hand-worked example of the dwt26_h3/dwt26_v3 lifting
+// steps, including the wrap at the row ends, then checks exact reconstruction on full-range random planes, where the
+// 16-bit arithmetic overflows. Also checks the quantizer's rounding toward zero.
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "dwt26.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define TEST_WIDTH 512				// One color field's LL2 at 4K.
+#define TEST_HEIGHT 384
+#define TEST_PLANES 8
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+u32 testKnownAnswer(void);
+u32 testReconstruction(void);
+u32 testQuantize(void);
+u32 testCompare(const char * name, const s16 * actual, const s16 * expected, u32 n);
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+int main(void)
+{
+	u32 errors = 0;
+
+	errors += testKnownAnswer();
+	errors += testReconstruction();
+	errors += testQuantize();
+
+	if(errors)
+	{
+		printf("FAIL: %u errors.\n", errors);
+		return 1;
+	}
+
+	printf("PASS: known answer, %u %ux%u planes reconstructed, quantizer.\n", TEST_PLANES, TEST_WIDTH, TEST_HEIGHT);
+	return 0;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+// Two identical rows of a ramp. Horizontally, pairs (10,12) (14,16) (18,20) (22,24) give S = 11 15 19 23 and D = 2.
+// Dout(0) = 2 + ((23 - 15 + 2) >>> 2) = 4 uses the wrapped S(-1) = S(3), and Dout(3) = 2 + ((19 - 11 + 2) >>> 2) = 4
+// the wrapped S(4) = S(0). Dout(1) = 2 + ((11 - 19 + 2) >>> 2) = 0 rounds -1.5 down. Vertically the rows are equal,
+// so L and H pass through to LL and HL, and LH and HH are zero.
+u32 testKnownAnswer(void)
+{
+	const s16 in[16] = {10, 12, 14, 16, 18, 20, 22, 24, 10, 12, 14, 16, 18, 20, 22, 24};
+	const s16 expLL[4] = {11, 15, 19, 23};
+	const s16 expHL[4] = {4, 0, 0, 4};
+	const s16 expZero[4] = {0, 0, 0, 0};
+	s16 LL[4], HL[4], LH[4], HH[4], scratch[16];
+	DWT26Subbands_s out = {LL, HL, LH, HH};
+	u32 errors = 0;
+
+	dwt26Forward(in, &out, scratch, 8, 2);
+
+	errors += testCompare("LL", LL, expLL, 4);
+	errors += testCompare("HL", HL, expHL, 4);
+	errors += testCompare("LH", LH, expZero, 4);
+	errors += testCompare("HH", HH, expZero, 4);
+	return errors;
+}
+
+u32 testReconstruction(void)
+{
+	u32 n = TEST_WIDTH * TEST_HEIGHT;
+	s16 * in = malloc(n * sizeof(s16));
+	s16 * rec = malloc(n * sizeof(s16));
+	s16 * scratch = malloc(n * sizeof(s16));
+	s16 * bands = malloc(n * sizeof(s16));
+	DWT26Subbands_s out = {bands, bands + n / 4, bands + n / 2, bands + 3 * n / 4};
+	u32 errors = 0;
+	u32 seed = 1;
+
+	for(u32 p = 0; p < TEST_PLANES; p++)
+	{
+		for(u32 i = 0; i < n; i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			in[i] = (s16)(seed >> 16);
+		}
+
+		dwt26Forward(in, &out, scratch, TEST_WIDTH, TEST_HEIGHT);
+		dwt26Inverse(&out, rec, scratch, TEST_WIDTH, TEST_HEIGHT);
+		errors += testCompare("reconstruction", rec, in, n);
+	}
+
+	free(in);
+	free(rec);
+	free(scratch);
+	free(bands);
+	return errors;
+}
+
+u32 testQuantize(void)
+{
+	const s16 x[6] = {301, -301, -300, -1, 32767, -32768};
+	const s16 qMult[6] = {128, 128, 128, 128, 256, 256};
+	const s16 expected[6] = {150, -150, -150, 0, 32767, -32768};
+	s16 actual[6];
+
+	for(u32 i = 0; i < 6; i++) { actual[i] = dwt26Quantize(x[i], qMult[i]); }
+
+	return testCompare("quantize", actual, expected, 6);
+}
+
+u32 testCompare(const char * name, const s16 * actual, const s16 * expected, u32 n)
+{
+	for(u32 i = 0; i < n; i++)
+	{
+		if(actual[i] != expected[i])
+		{
+			printf("%s[%u]: %d, expected %d.\n", name, i, actual[i], expected[i]);
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,18 @@
+// Host stand-in for src/main.h, with just what ring.c and the host tools need.
+
+#ifndef __MAIN_INCLUDE__
+#define __MAIN_INCLUDE__
+
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef int16_t s16;
+typedef uint32_t u32;
+typedef int32_t s32;
+typedef uint64_t u64;
+
+#define OCM_TEXT
+#define OCM_DATA
+
+#endif
@@ -0,0 +1,127 @@
+/*
+WAVE Ring Buffer Host Stress Test
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Two-thread producer/consumer stress test of ring.c, built and run on the host with `make`. Checks that every item
+// arrives exactly once, in order, and intact, including across the wrap of the free-running head and tail counts.
+// Both sides yield while the ring is full or empty, so it also runs on single-CPU hosts.
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+#include "ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define TEST_ITEMS 2000000
+#define TEST_SLOTS 64				// A power of two, so slot indices stay continuous across the u32 wrap.
+
+// Private Type Definitions --------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	u32 seq;
+	u32 check;
+	u64 payload[2];
+} TestItem_s;
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+void * testProducer(void * arg);
+void * testConsumer(void * arg);
+
+// Private Global Variables --------------------------------------------------------------------------------------------
+
+Ring_s testRing;
+TestItem_s testSlots[TEST_SLOTS];
+u32 testErrors = 0;
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+int main(void)
+{
+	pthread_t producer, consumer;
+
+	ringInit(&testRing, testSlots, TEST_SLOTS, sizeof(TestItem_s));
+
+	// Start just short of the u32 wrap.
+	testRing.head = 0xFFFFF000;
+	testRing.tail = 0xFFFFF000;
+
+	pthread_create(&consumer, NULL, testConsumer, NULL);
+	pthread_create(&producer, NULL, testProducer, NULL);
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+
+	if(ringCount(&testRing) != 0)
+	{
+		printf("FAIL: %u items left in the ring.\n", ringCount(&testRing));
+		testErrors++;
+	}
+
+	printf("%s: %u items, %u full-ring retries, %u errors.\n", testErrors ? "FAIL" : "PASS",
+	       TEST_ITEMS, testRing.nOverruns, testErrors);
+
+	return testErrors ? 1 : 0;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+void * testProducer(void * arg)
+{
+	TestItem_s item;
+
+	for(u32 i = 0; i < TEST_ITEMS; i++)
+	{
+		item.seq = i;
+		item.check = ~i;
+		item.payload[0] = (u64) i * 0x9E3779B97F4A7C15ull;
+		item.payload[1] = ~item.payload[0];
+		while(!ringPush(&testRing, &item)) { sched_yield(); }
+	}
+
+	return NULL;
+}
+
+void * testConsumer(void * arg)
+{
+	TestItem_s item;
+
+	for(u32 i = 0; i < TEST_ITEMS; i++)
+	{
+		while(!ringPop(&testRing, &item)) { sched_yield(); }
+
+		// A lost or duplicated item shows up as a sequence break, a torn one as a bad check.
+		if((item.seq != i) || (item.check != ~i)
+		|| (item.payload[0] != (u64) i * 0x9E3779B97F4A7C15ull) || (item.payload[1] != ~item.payload[0]))
+		{
+			if(testErrors < 10) { printf("Item %u: got seq %u, check %08x.\n", i, item.seq, item.check); }
+			testErrors++;
+		}
+	}
+
+	return NULL;
+}
@@ -0,0 +1,126 @@
+/*
+WAVE 2/6 DWT Host Reference
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "dwt26.h"
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+void dwt26Forward1D(const s16 * x, u32 xStride, s16 * sOut, s16 * dOut, u32 outStride, u32 nPairs);
+void dwt26Inverse1D(const s16 * sIn, const s16 * dIn, u32 inStride, s16 * x, u32 xStride, u32 nPairs);
+s16 dwt26Predict(s16 sPrev, s16 sNext);
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+void dwt26Forward(const s16 * in, DWT26Subbands_s * out, s16 * scratch, u32 width, u32 height)
+{
+	u32 wOut = width / 2;
+	s16 * L = scratch;							// Horizontal outputs, each height x wOut.
+	s16 * H = scratch + height * wOut;
+
+	// Horizontal (dwt26_h3): one row at a time.
+	for(u32 y = 0; y < height; y++)
+	{
+		dwt26Forward1D(&in[y * width], 1, &L[y * wOut], &H[y * wOut], 1, wOut);
+	}
+
+	// Vertical (dwt26_v3): one column at a time, on each horizontal output.
+	for(u32 x = 0; x < wOut; x++)
+	{
+		dwt26Forward1D(&L[x], wOut, &out->LL[x], &out->LH[x], wOut, height / 2);
+		dwt26Forward1D(&H[x], wOut, &out->HL[x], &out->HH[x], wOut, height / 2);
+	}
+}
+
+void dwt26Inverse(const DWT26Subbands_s * in, s16 * out, s16 * scratch, u32 width, u32 height)
+{
+	u32 wOut = width / 2;
+	s16 * L = scratch;
+	s16 * H = scratch + height * wOut;
+
+	for(u32 x = 0; x < wOut; x++)
+	{
+		dwt26Inverse1D(&in->LL[x], &in->LH[x], wOut, &L[x], wOut, height / 2);
+		dwt26Inverse1D(&in->HL[x], &in->HH[x], wOut, &H[x], wOut, height / 2);
+	}
+
+	for(u32 y = 0; y < height; y++)
+	{
+		dwt26Inverse1D(&L[y * wOut], &H[y * wOut], 1, &out[y * width], 1, wOut);
+	}
+}
+
+s16 dwt26Quantize(s16 x, s16 qMult)
+{
+	// DSP48E2 A*B+C, with C = 255 for negative inputs so that the arithmetic shift rounds toward zero.
+	s32 product = (s32) x * qMult + ((x < 0) ? 0xFF : 0);
+	return (s16)(product >> 8);
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+// One 2/6 lifting pass over nPairs pixel pairs, wrapping at the ends:
+//     Local Difference:                 D(n) = Xodd(n) - Xeven(n)
+//     Local and Output Sum:   Sout(n) = S(n) = Xeven(n) + (D(n) >>> 1)
+//     Output Difference:      Dout(n) = D(n) + ((S(n-1) - S(n+1) + 2) >>> 2)
+void dwt26Forward1D(const s16 * x, u32 xStride, s16 * sOut, s16 * dOut, u32 outStride, u32 nPairs)
+{
+	for(u32 n = 0; n < nPairs; n++)
+	{
+		s16 xEven = x[(2 * n) * xStride];
+		s16 xOdd = x[(2 * n + 1) * xStride];
+		s16 d = (s16)(xOdd - xEven);
+		sOut[n * outStride] = (s16)(xEven + (d >> 1));
+		dOut[n * outStride] = d;
+	}
+
+	// The local sums are final, so the prediction can run in place on the local differences.
+	for(u32 n = 0; n < nPairs; n++)
+	{
+		s16 sPrev = sOut[((n + nPairs - 1) % nPairs) * outStride];
+		s16 sNext = sOut[((n + 1) % nPairs) * outStride];
+		dOut[n * outStride] = (s16)(dOut[n * outStride] + dwt26Predict(sPrev, sNext));
+	}
+}
+
+void dwt26Inverse1D(const s16 * sIn, const s16 * dIn, u32 inStride, s16 * x, u32 xStride, u32 nPairs)
+{
+	for(u32 n = 0; n < nPairs; n++)
+	{
+		s16 s = sIn[n * inStride];
+		s16 sPrev = sIn[((n + nPairs - 1) % nPairs) * inStride];
+		s16 sNext = sIn[((n + 1) % nPairs) * inStride];
+		s16 d = (s16)(dIn[n * inStride] - dwt26Predict(sPrev, sNext));
+		s16 xEven = (s16)(s - (d >> 1));
+		x[(2 * n) * xStride] = xEven;
+		x[(2 * n + 1) * xStride] = (s16)(xEven + d);
+	}
+}
+
+// The HDL sizes this expression to 16 bits, so the sum wraps before the shift.
+s16 dwt26Predict(s16 sPrev, s16 sNext)
+{
+	return (s16)((s16)(sPrev - sNext + 2) >> 2);
+}
@@ -0,0 +1,65 @@
+/*
+WAVE 2/6 DWT Host Reference Include
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Bit-exact host model of the third wavelet stage (Wavelet_S3: dwt26_h3.v, dwt26_v3.v), for measuring a third
+// decomposition level offline before the encoder can record one.
+
+#ifndef __DWT26_INCLUDE__
+#define __DWT26_INCLUDE__
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include "main.h"
+
+// Public Pre-Processor Definitions ------------------------------------------------------------------------------------
+
+// Public Type Definitions ---------------------------------------------------------------------------------------------
+
+// Subbands of one decomposition level, each (width / 2) x (height / 2), row-major. HL is horizontal high, vertical low.
+typedef struct
+{
+	s16 * LL;
+	s16 * HL;
+	s16 * LH;
+	s16 * HH;
+} DWT26Subbands_s;
+
+// Public Function Prototypes ------------------------------------------------------------------------------------------
+
+// Forward 2/6 DWT of one color field's LL2 plane, row-major, with even width and height. Horizontal first, then
+// vertical, in signed 16-bit arithmetic that wraps like the HDL's. Both edges wrap around: the horizontal cores are
+// chained in a ring and the vertical core's row buffer is circular, so the rows above the top are the previous
+// frame's last rows. This models a static scene, where those are this frame's last rows.
+// Scratch must hold width * height values.
+void dwt26Forward(const s16 * in, DWT26Subbands_s * out, s16 * scratch, u32 width, u32 height);
+
+// Exact inverse of dwt26Forward.
+void dwt26Inverse(const DWT26Subbands_s * in, s16 * out, s16 * scratch, u32 width, u32 height);
+
+// Encoder quantizer (quantizer_4x16.v): x * qMult / 256, rounded toward zero. qMult is 0-256.
+s16 dwt26Quantize(s16 x, s16 qMult);
+
+// Externed Public Global Variables ------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,142 @@
+/*
+WAVE Event Trace Decoder
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Decodes a trace read over USB with the WAVE READ TRACE vendor command (0xC2) into CSV, one record per line, oldest
+// first. To capture on Linux, with the camera's USB drive at /dev/sdX:
+//
+//   sg_raw -r 65552 -o trace.bin /dev/sdX c2 00 00 00 00 00 00 00 00 00
+//   trace_decode trace.bin > trace.csv
+//
+// Times are relative to the first record from the same core, since cycle counts are per-core.
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define TRACE_DECODE_NUM_CORES	4
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+const char * traceEventName(u16 event);
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+int main(int argc, char * argv[])
+{
+	TraceExportHeader_s header;
+	TraceRecord_s record;
+	u64 tFirst[TRACE_DECODE_NUM_CORES];
+	u8 tFirstValid[TRACE_DECODE_NUM_CORES] = {0};
+	FILE * fp;
+
+	if(argc != 2)
+	{
+		fprintf(stderr, "Usage: %s trace.bin\n", argv[0]);
+		return 2;
+	}
+
+	fp = fopen(argv[1], "rb");
+	if(fp == NULL)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	if((fread(&header, sizeof(header), 1, fp) != 1) || (memcmp(header.strMagic, "TRCE", 4) != 0))
+	{
+		fprintf(stderr, "%s: Not a WAVE trace export.\n", argv[1]);
+		fclose(fp);
+		return 1;
+	}
+
+	if((header.version != TRACE_EXPORT_VERSION) || (header.recordSize != sizeof(TraceRecord_s))
+	   || (header.cyclesPerUs == 0))
+	{
+		fprintf(stderr, "%s: Unsupported trace export (version %u, %u-byte records).\n", argv[1], header.version,
+		        header.recordSize);
+		fclose(fp);
+		return 1;
+	}
+
+	printf("core,cycles,us,event,arg\n");
+	for(u32 i = 0; i < header.nRecords; i++)
+	{
+		if(fread(&record, sizeof(record), 1, fp) != 1)
+		{
+			fprintf(stderr, "%s: Truncated after %u of %u records.\n", argv[1], i, header.nRecords);
+			fclose(fp);
+			return 1;
+		}
+
+		double t_us = 0.0;
+		if(record.core < TRACE_DECODE_NUM_CORES)
+		{
+			if(!tFirstValid[record.core])
+			{
+				tFirst[record.core] = record.tCycles;
+				tFirstValid[record.core] = 1;
+			}
+			t_us = (double)(record.tCycles - tFirst[record.core]) / header.cyclesPerUs;
+		}
+
+		printf("%u,%llu,%.3f,%s,%u\n", record.core, (unsigned long long) record.tCycles, t_us,
+		       traceEventName(record.event), record.arg);
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+// Same names as the on-camera dump in trace.c.
+const char * traceEventName(u16 event)
+{
+	switch(event)
+	{
+	case TRACE_FOT_ENTER: return "FOT_ENTER";
+	case TRACE_FOT_CRITICAL_EXIT: return "FOT_CRITICAL_EXIT";
+	case TRACE_FOT_EXIT: return "FOT_EXIT";
+	case TRACE_VSYNC_ENTER: return "VSYNC_ENTER";
+	case TRACE_VSYNC_EXIT: return "VSYNC_EXIT";
+	case TRACE_IMU_ENTER: return "IMU_ENTER";
+	case TRACE_IMU_EXIT: return "IMU_EXIT";
+	case TRACE_FOT_BH_ENTER: return "FOT_BH_ENTER";
+	case TRACE_FOT_BH_EXIT: return "FOT_BH_EXIT";
+	case TRACE_REC_ENTER: return "REC_ENTER";
+	case TRACE_REC_PREP: return "REC_PREP";
+	case TRACE_REC_HEADERS: return "REC_HEADERS";
+	case TRACE_REC_EXIT: return "REC_EXIT";
+	case TRACE_NVME_SUBMIT: return "NVME_SUBMIT";
+	case TRACE_NVME_COMPLETE: return "NVME_COMPLETE";
+	case TRACE_SERVICE: return "SERVICE";
+	default: return "UNKNOWN";
+	}
+}
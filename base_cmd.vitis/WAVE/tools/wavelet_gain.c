@@ -0,0 +1,177 @@
+/*
+WAVE Wavelet Stage 3 Gain Estimate
+
+Copyright (C) 2020 by Shane W. Colton
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Estimates what a third wavelet stage would save on one color field's LL2 plane. Codestream 0 stores LL2 raw at
+// 10 bits per value. With a third stage, LL3 would be stored the same way at a quarter of the count, and HL3, LH3, and
+// HH3 would be quantized and entropy coded like the other high bands. Each of those is costed at its zeroth-order
+// entropy, a lower bound for the encoder's variable-length code. At qMult 256 the stage 3 bands are not quantized, so
+// the comparison is at equal quality.
+//
+//   wavelet_gain [qMult [ll2.raw width height]]
+//
+// ll2.raw is row-major signed 16-bit little-endian. Without it, a synthetic 512x384 plane is used.
+
+// Include Headers -----------------------------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dwt26.h"
+
+// Private Pre-Processor Definitions -----------------------------------------------------------------------------------
+
+#define GAIN_LL_BITS		10			// Raw LL bits per value, as in compressor_LL2.v.
+#define GAIN_SYNTH_WIDTH	512			// One color field's LL2 at 4K.
+#define GAIN_SYNTH_HEIGHT	384
+
+// Private Function Prototypes -----------------------------------------------------------------------------------------
+
+void gainSynthesize(s16 * plane, u32 width, u32 height);
+double gainEntropy(const s16 * band, u32 n, s16 qMult);
+
+// Public Function Definitions -----------------------------------------------------------------------------------------
+
+int main(int argc, char * argv[])
+{
+	s16 qMult = 256;
+	u32 width = GAIN_SYNTH_WIDTH;
+	u32 height = GAIN_SYNTH_HEIGHT;
+	s16 * plane;
+
+	if((argc != 1) && (argc != 2) && (argc != 5))
+	{
+		fprintf(stderr, "Usage: %s [qMult [ll2.raw width height]]\n", argv[0]);
+		return 2;
+	}
+
+	if(argc >= 2)
+	{
+		qMult = (s16) atoi(argv[1]);
+		if((qMult < 1) || (qMult > 256))
+		{
+			fprintf(stderr, "qMult must be 1-256.\n");
+			return 2;
+		}
+	}
+
+	if(argc == 5)
+	{
+		width = (u32) atoi(argv[3]);
+		height = (u32) atoi(argv[4]);
+		if((width < 4) || (height < 4) || (width & 1) || (height & 1))
+		{
+			fprintf(stderr, "Width and height must be even and at least 4.\n");
+			return 2;
+		}
+	}
+
+	u32 n = width * height;
+	plane = malloc(n * sizeof(s16));
+	s16 * scratch = malloc(n * sizeof(s16));
+	s16 * bands = malloc(n * sizeof(s16));
+	DWT26Subbands_s out = {bands, bands + n / 4, bands + n / 2, bands + 3 * n / 4};
+
+	if(argc == 5)
+	{
+		FILE * fp = fopen(argv[2], "rb");
+		if(fp == NULL)
+		{
+			perror(argv[2]);
+			return 1;
+		}
+		if(fread(plane, sizeof(s16), n, fp) != n)
+		{
+			fprintf(stderr, "%s: Shorter than %ux%u.\n", argv[2], width, height);
+			fclose(fp);
+			return 1;
+		}
+		fclose(fp);
+	}
+	else
+	{
+		gainSynthesize(plane, width, height);
+	}
+
+	dwt26Forward(plane, &out, scratch, width, height);
+
+	double bitsHL = gainEntropy(out.HL, n / 4, qMult);
+	double bitsLH = gainEntropy(out.LH, n / 4, qMult);
+	double bitsHH = gainEntropy(out.HH, n / 4, qMult);
+	double bits2 = (double) GAIN_LL_BITS * n;
+	double bits3 = (GAIN_LL_BITS + bitsHL + bitsLH + bitsHH) * (n / 4);
+
+	printf("LL2 %ux%u, qMult %d.\n", width, height, qMult);
+	printf("Two stages:   LL2 %5.2f b/px.\n", (double) GAIN_LL_BITS);
+	printf("Three stages: LL3 %5.2f, HL3 %5.2f, LH3 %5.2f, HH3 %5.2f b/px of each band.\n", (double) GAIN_LL_BITS, bitsHL,
+	       bitsLH, bitsHH);
+	printf("Codestream 0: %.0f -> %.0f bytes per color field (%+.1f%%).\n", bits2 / 8, bits3 / 8,
+	       100.0 * (bits3 - bits2) / bits2);
+
+	free(plane);
+	free(scratch);
+	free(bands);
+	return 0;
+}
+
+// Private Function Definitions ----------------------------------------------------------------------------------------
+
+// Smooth shading and a few soft edges, with about one LSB of noise, in 10 bits.
+void gainSynthesize(s16 * plane, u32 width, u32 height)
+{
+	u32 seed = 1;
+
+	for(u32 y = 0; y < height; y++)
+	{
+		for(u32 x = 0; x < width; x++)
+		{
+			double v = 300.0 + 200.0 * x / width + 150.0 * y / height;
+			v += 120.0 * sin(x * 0.05) * cos(y * 0.03);
+			v += ((x / 64 + y / 48) & 1) ? 80.0 : 0.0;
+			seed = seed * 1664525 + 1013904223;
+			v += (double)((seed >> 16) & 3) - 1.5;
+			if(v < 0.0) { v = 0.0; }
+			if(v > 1023.0) { v = 1023.0; }
+			plane[y * width + x] = (s16) v;
+		}
+	}
+}
+
+double gainEntropy(const s16 * band, u32 n, s16 qMult)
+{
+	u32 * count = calloc(65536, sizeof(u32));
+	double bits = 0.0;
+
+	for(u32 i = 0; i < n; i++) { count[(u16) dwt26Quantize(band[i], qMult)]++; }
+
+	for(u32 v = 0; v < 65536; v++)
+	{
+		if(count[v] == 0) { continue; }
+		double p = (double) count[v] / n;
+		bits -= p * log2(p);
+	}
+
+	free(count);
+	return bits;
+}